@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "tsc_clock.hpp"
+
+// Binary asynchronous logger for diagnostics off the hot path. A LOG_* call copies
+// a call-site ID, a TSC stamp and its raw arguments into the calling thread's own SPSC
+// byte ring; nothing is formatted and no lock or syscall is taken. A background thread
+// drains every ring, formats records against the call site's "{}" format string and
+// writes them to the log file. A full ring drops the record (counted) rather than wait.
+// Lines from different threads are written in drain order, not strictly by time.
+//
+//   LOG_WARN("TCP loopback: cannot connect to venue on port {}", port);
+
+enum class LogLevel : uint8_t { TRACE, INFO, WARN, ERROR };
+
+enum class LogArgKind : uint8_t { SIGNED, UNSIGNED, FLOAT, STRING };
+
+// One per LOG_* call site, registered on first use.
+struct LogSite {
+    LogLevel level;
+    const char* file;
+    int line;
+    std::atomic<uint32_t> id{0};
+};
+
+template <typename T>
+constexpr LogArgKind log_arg_kind() {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*> || std::is_same_v<U, std::string>)
+        return LogArgKind::STRING;
+    else if constexpr (std::is_floating_point_v<U>) return LogArgKind::FLOAT;
+    else if constexpr (std::is_enum_v<U>)
+        return std::is_signed_v<std::underlying_type_t<U>> ? LogArgKind::SIGNED : LogArgKind::UNSIGNED;
+    else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) return LogArgKind::SIGNED;
+    else {
+        static_assert(std::is_integral_v<U>, "LOG_* arguments must be numbers, enums or strings");
+        return LogArgKind::UNSIGNED;
+    }
+}
+
+// Single-writer, single-reader byte ring of 8-byte aligned records. A record that would
+// straddle the end is preceded by a padding record (id 0) covering the tail.
+class LogRing {
+public:
+    struct Header {
+        uint32_t id;    // call site, 0 = padding
+        uint32_t size;  // whole record in bytes
+        uint64_t tsc;
+    };
+    static constexpr size_t CAPACITY = 1 << 16;
+    static constexpr uint32_t MAX_STRING = 256;
+private:
+    std::unique_ptr<char[]> data_{new char[CAPACITY]()}; // zeroed, so the pages fault in here and not on a log call
+    alignas(64) std::atomic<uint64_t> head_{0};
+    uint64_t cached_tail_ = 0;
+    uint64_t pad_ = 0;  // wrap padding written by reserve(), published with the record by commit()
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    std::atomic<uint64_t> dropped_{0};
+public:
+    // Writer: room for size bytes (a multiple of 8), or nullptr when full. The record,
+    // and any padding in front of it, become visible to the reader at commit().
+    char* reserve(size_t size) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        size_t pos = head & (CAPACITY - 1);
+        size_t pad = CAPACITY - pos < size ? CAPACITY - pos : 0;
+        if (head + pad + size - cached_tail_ > CAPACITY) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head + pad + size - cached_tail_ > CAPACITY) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        if (pad) {
+            Header h{0, static_cast<uint32_t>(pad), 0};
+            std::memcpy(data_.get() + pos, &h, 8);
+            pos = 0;
+        }
+        pad_ = pad;
+        return data_.get() + pos;
+    }
+    void commit(size_t size) {
+        head_.store(head_.load(std::memory_order_relaxed) + pad_ + size, std::memory_order_release);
+    }
+
+    // Reader: calls f(const Header&, const char* args) for each record; returns the count.
+    template <typename F>
+    size_t drain(F&& f) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        uint64_t head = head_.load(std::memory_order_acquire);
+        size_t n = 0;
+        while (tail < head) {
+            const char* p = data_.get() + (tail & (CAPACITY - 1));
+            Header h;
+            std::memcpy(&h, p, 8);
+            if (h.id != 0) {
+                std::memcpy(&h, p, sizeof(h));
+                f(h, p + sizeof(h));
+                n++;
+            }
+            tail += h.size;
+        }
+        tail_.store(tail, std::memory_order_release);
+        return n;
+    }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+};
+
+class AsyncLogger {
+    struct SiteInfo {
+        LogLevel level;
+        const char* fmt;
+        const char* file;
+        int line;
+        std::vector<LogArgKind> kinds;
+    };
+    std::mutex mutex_;                       // sites_, rings_, file_
+    std::vector<SiteInfo> sites_{1};         // id 0 is the padding record
+    std::vector<std::unique_ptr<LogRing>> rings_;
+    std::FILE* file_ = nullptr;
+    std::thread writer_;
+    std::atomic<bool> running_{false};
+    uint64_t start_tsc_ = tsc_now();
+    uint64_t written_ = 0;
+
+    static size_t arg_size(const char* s) { return 4 + std::min<size_t>(std::strlen(s), LogRing::MAX_STRING); }
+    static size_t arg_size(const std::string& s) { return 4 + std::min<size_t>(s.size(), LogRing::MAX_STRING); }
+    template <size_t N>
+    static size_t arg_size(const char (&s)[N]) { return 4 + std::min<size_t>(strnlen(s, N), LogRing::MAX_STRING); }
+    template <typename T>
+    static size_t arg_size(const T&) { return 8; }
+
+    static char* put_string(char* p, const char* s, size_t n) {
+        uint32_t len = static_cast<uint32_t>(std::min<size_t>(n, LogRing::MAX_STRING));
+        std::memcpy(p, &len, 4);
+        std::memcpy(p + 4, s, len);
+        return p + 4 + len;
+    }
+    static char* put(char* p, const char* s) { return put_string(p, s, std::strlen(s)); }
+    static char* put(char* p, const std::string& s) { return put_string(p, s.data(), s.size()); }
+    template <size_t N>
+    static char* put(char* p, const char (&s)[N]) { return put_string(p, s, strnlen(s, N)); }
+    template <typename T>
+    static char* put(char* p, const T& v) {
+        constexpr LogArgKind k = log_arg_kind<T>();
+        if constexpr (k == LogArgKind::FLOAT) { double d = static_cast<double>(v); std::memcpy(p, &d, 8); }
+        else if constexpr (k == LogArgKind::SIGNED) { int64_t i = static_cast<int64_t>(v); std::memcpy(p, &i, 8); }
+        else { uint64_t u = static_cast<uint64_t>(v); std::memcpy(p, &u, 8); }
+        return p + 8;
+    }
+
+    LogRing& thread_ring() {
+        thread_local LogRing* ring = nullptr;
+        if (!ring) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings_.push_back(std::make_unique<LogRing>());
+            ring = rings_.back().get();
+        }
+        return *ring;
+    }
+    uint32_t register_site(LogSite& site, const char* fmt, const LogArgKind* kinds, size_t n) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t id = site.id.load(std::memory_order_relaxed);
+        if (id) return id;
+        sites_.push_back(SiteInfo{site.level, fmt, site.file, site.line, std::vector<LogArgKind>(kinds, kinds + n)});
+        id = static_cast<uint32_t>(sites_.size() - 1);
+        site.id.store(id, std::memory_order_release);
+        return id;
+    }
+
+    void format(const SiteInfo& site, const LogRing::Header& h, const char* args, std::string& out) const {
+        static const char* levels[] = {"TRACE", "INFO ", "WARN ", "ERROR"};
+        char prefix[64];
+        std::snprintf(prefix, sizeof(prefix), "%12.6f %s ", tsc_to_ns(h.tsc - start_tsc_) / 1e9,
+                      levels[static_cast<int>(site.level)]);
+        out = prefix;
+        size_t next = 0;
+        for (const char* f = site.fmt; *f; ++f) {
+            if (f[0] != '{' || f[1] != '}' || next == site.kinds.size()) { out += *f; continue; }
+            f++;
+            char buf[32];
+            switch (site.kinds[next++]) {
+                case LogArgKind::SIGNED: { int64_t v; std::memcpy(&v, args, 8); args += 8; out += std::to_string(v); break; }
+                case LogArgKind::UNSIGNED: { uint64_t v; std::memcpy(&v, args, 8); args += 8; out += std::to_string(v); break; }
+                case LogArgKind::FLOAT: {
+                    double v;
+                    std::memcpy(&v, args, 8);
+                    args += 8;
+                    std::snprintf(buf, sizeof(buf), "%g", v);
+                    out += buf;
+                    break;
+                }
+                case LogArgKind::STRING: {
+                    uint32_t len;
+                    std::memcpy(&len, args, 4);
+                    out.append(args + 4, len);
+                    args += 4 + len;
+                    break;
+                }
+            }
+        }
+        out += '\n';
+    }
+    // Drains every ring once; returns the number of records written.
+    size_t drain() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string line;
+        size_t n = 0;
+        for (auto& ring : rings_)
+            n += ring->drain([&](const LogRing::Header& h, const char* args) {
+                format(sites_[h.id], h, args, line);
+                if (file_) std::fwrite(line.data(), 1, line.size(), file_);
+            });
+        written_ += n;
+        if (n && file_) std::fflush(file_);
+        return n;
+    }
+    void run() {
+        while (running_.load(std::memory_order_relaxed))
+            if (!drain()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        drain();
+    }
+public:
+    static AsyncLogger& instance() {
+        static AsyncLogger logger;
+        return logger;
+    }
+    ~AsyncLogger() { stop(); }
+
+    // Opens path (appending) and starts the writer thread. Records logged before this
+    // wait in their rings.
+    bool start(const char* path) {
+        if (running_.load()) return true;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            file_ = std::fopen(path, "a");
+            if (!file_) return false;
+        }
+        running_ = true;
+        writer_ = std::thread(&AsyncLogger::run, this);
+        return true;
+    }
+    // Writes out everything logged so far and closes the file.
+    void stop() {
+        if (!running_.exchange(false)) return;
+        if (writer_.joinable()) writer_.join();
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    // Hot path. fmt must be a string literal (only its pointer is kept).
+    template <typename... Args>
+    void log(LogSite& site, const char* fmt, const Args&... args) {
+        static constexpr LogArgKind kinds[sizeof...(Args) + 1] = {log_arg_kind<Args>()..., LogArgKind::STRING};
+        uint32_t id = site.id.load(std::memory_order_acquire);
+        if (!id) id = register_site(site, fmt, kinds, sizeof...(Args));
+        size_t size = (sizeof(LogRing::Header) + (arg_size(args) + ... + 0) + 7) & ~size_t(7);
+        LogRing& ring = thread_ring();
+        char* p = ring.reserve(size);
+        if (!p) return;
+        LogRing::Header h{id, static_cast<uint32_t>(size), tsc_now()};
+        std::memcpy(p, &h, sizeof(h));
+        char* a = p + sizeof(h);
+        ((a = put(a, args)), ...);
+        (void)a;
+        ring.commit(size);
+    }
+
+    uint64_t dropped() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t n = 0;
+        for (auto& ring : rings_) n += ring->dropped();
+        return n;
+    }
+    uint64_t written() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return written_;
+    }
+};
+
+#define LOG_AT(level, ...)                                                        \
+    do {                                                                          \
+        static LogSite llp_log_site_{level, __FILE__, __LINE__};                  \
+        AsyncLogger::instance().log(llp_log_site_, __VA_ARGS__);                  \
+    } while (0)
+#define LOG_TRACE(...) LOG_AT(LogLevel::TRACE, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LogLevel::WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::ERROR, __VA_ARGS__)
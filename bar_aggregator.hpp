@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "broadcast_ring.hpp"
+#include "matching_engine.hpp"
+
+// OHLCV bar for one symbol and interval; one cache line so symbols never share.
+struct alignas(64) Bar {
+    uint64_t start_ns = 0;   // interval start on the steady clock
+    uint64_t volume = 0;
+    uint64_t notional = 0;   // sum of price_cents * qty
+    uint32_t open = 0, high = 0, low = 0, close = 0;
+    uint32_t trades = 0;
+    double vwap() const { return volume ? static_cast<double>(notional) / volume : 0.0; }
+};
+
+struct BarAggregatorStats {
+    uint64_t trades = 0;
+    uint64_t missed = 0;        // prints overwritten before this consumer read them
+    uint64_t bars_closed = 0;
+    uint64_t empty_closed = 0;  // intervals without a trade (not reported)
+};
+
+// Analytics consumer of the trade tape: keeps 1s and 1m OHLCV bars plus session
+// VWAP per interned symbol in flat arrays indexed [interval][symbol_id]. A single
+// thread owns all of it, so updates are plain stores and bars close from poll()'s
+// clock check rather than under a lock shared with the matcher.
+class BarAggregator {
+public:
+    static constexpr size_t INTERVALS = 2;
+    static constexpr std::array<uint64_t, INTERVALS> INTERVAL_NS = {1000000000ull, 60000000000ull};
+    static constexpr std::array<const char*, INTERVALS> INTERVAL_NAMES = {"1s", "1m"};
+private:
+    struct alignas(64) Session {
+        uint64_t volume = 0;
+        uint64_t notional = 0;
+    };
+    const BroadcastRing<TradePrint>& tape_;
+    uint64_t cursor_;
+    size_t max_symbols_;
+    std::vector<Bar> bars_;          // INTERVALS * max_symbols_
+    std::vector<Session> session_;
+    std::array<uint64_t, INTERVALS> boundary_{}; // end of the current bar per interval
+    BarAggregatorStats stats_;
+
+    Bar& bar(size_t interval, uint32_t symbol_id) { return bars_[interval * max_symbols_ + symbol_id]; }
+
+    template <typename OnClose>
+    void close_through(uint64_t now_ns, OnClose& on_close) {
+        for (size_t k = 0; k < INTERVALS; ++k) {
+            if (now_ns < boundary_[k]) continue;
+            for (uint32_t s = 0; s < max_symbols_; ++s) {
+                Bar& b = bar(k, s);
+                if (b.trades) { on_close(k, s, b); stats_.bars_closed++; }
+                else stats_.empty_closed++;
+                b = Bar{};
+            }
+            boundary_[k] = (now_ns / INTERVAL_NS[k] + 1) * INTERVAL_NS[k];
+        }
+    }
+    void apply(const TradePrint& t) {
+        if (t.symbol_id >= max_symbols_) return;
+        uint64_t notional = static_cast<uint64_t>(t.price_cents) * t.qty;
+        for (size_t k = 0; k < INTERVALS; ++k) {
+            Bar& b = bar(k, t.symbol_id);
+            if (b.trades == 0) {
+                b.start_ns = boundary_[k] - INTERVAL_NS[k];
+                b.open = b.high = b.low = t.price_cents;
+            }
+            b.high = std::max(b.high, t.price_cents);
+            b.low = std::min(b.low, t.price_cents);
+            b.close = t.price_cents;
+            b.volume += t.qty;
+            b.notional += notional;
+            b.trades++;
+        }
+        Session& s = session_[t.symbol_id];
+        s.volume += t.qty;
+        s.notional += notional;
+        stats_.trades++;
+    }
+public:
+    BarAggregator(const BroadcastRing<TradePrint>& tape, size_t max_symbols, uint64_t now_ns)
+        : tape_(tape), cursor_(tape.head()), max_symbols_(max_symbols),
+          bars_(INTERVALS * max_symbols), session_(max_symbols) {
+        for (size_t k = 0; k < INTERVALS; ++k) boundary_[k] = (now_ns / INTERVAL_NS[k] + 1) * INTERVAL_NS[k];
+    }
+
+    // Folds every available print into the open bars, closing any bar whose interval
+    // ended first (by the print's timestamp, then by now_ns for idle symbols). A print
+    // read after its bar already closed on the timer counts toward the open bar.
+    // on_close(interval, symbol_id, const Bar&) sees each non-empty bar once.
+    // Returns the number of prints consumed.
+    template <typename OnClose>
+    size_t poll(uint64_t now_ns, OnClose&& on_close) {
+        uint64_t before = stats_.trades;
+        TradePrint t;
+        for (;;) {
+            auto r = tape_.read(cursor_, t);
+            if (r == BroadcastRing<TradePrint>::ReadResult::EMPTY) break;
+            if (r == BroadcastRing<TradePrint>::ReadResult::LAPPED) {
+                uint64_t head = tape_.head();
+                stats_.missed += head - cursor_;
+                cursor_ = head;
+                continue;
+            }
+            close_through(t.ts_ns, on_close);
+            apply(t);
+        }
+        close_through(now_ns, on_close);
+        return static_cast<size_t>(stats_.trades - before);
+    }
+
+    const Bar& current(size_t interval, uint32_t symbol_id) const { return bars_[interval * max_symbols_ + symbol_id]; }
+    double session_vwap(uint32_t symbol_id) const {
+        const Session& s = session_[symbol_id];
+        return s.volume ? static_cast<double>(s.notional) / s.volume : 0.0;
+    }
+    uint64_t session_volume(uint32_t symbol_id) const { return session_[symbol_id].volume; }
+    const BarAggregatorStats& stats() const { return stats_; }
+};
@@ -6,14 +6,17 @@
 #include "order.hpp"
 
 class Batcher {
+public:
+    using SendFn = std::function<void(const std::vector<Order>&, uint64_t)>;
+private:
     std::vector<Order> buffer_;
     size_t batch_size_;
     std::chrono::microseconds timeout_;
     std::chrono::high_resolution_clock::time_point first_time_;
     bool started_ = false;
-    std::function<void(const std::vector<Order>&, uint64_t)> send_;
+    SendFn send_;
 public:
-    Batcher(size_t batch_size, std::chrono::microseconds timeout, std::function<void(const std::vector<Order>&, uint64_t)> send)
+    Batcher(size_t batch_size, std::chrono::microseconds timeout, SendFn send)
         : batch_size_(batch_size), timeout_(timeout), send_(send) {}
     void add_order(const Order& o) {
         if (!started_) { first_time_ = std::chrono::high_resolution_clock::now(); started_ = true; }
@@ -0,0 +1,912 @@
+// Matching-path microbenchmarks for the venue-side engine.
+// Build with `make bench` (or the book_bench CMake target) and run ./book_bench.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include "matching_engine.hpp"
+#include "order_book.hpp"
+#include "prefix_sum.hpp"
+#include "bar_aggregator.hpp"
+#include "position_keeper.hpp"
+#include "order_router.hpp"
+#include "feed_arbiter.hpp"
+#include "reorder_buffer.hpp"
+#include "ring_buffer.hpp"
+#include "rate_shaper.hpp"
+#include "fair_ingress.hpp"
+#include "reuseport_ingress.hpp"
+#include "async_logger.hpp"
+#include "pcap_capture.hpp"
+#include "epoch.hpp"
+#include "combining_batcher.hpp"
+#include "mpsc_queue.hpp"
+#include "instrument_registry.hpp"
+#include "latency_histogram.hpp"
+#include "wire.hpp"
+#include "src/network_sim/link_model.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+static Order make_order(uint64_t id, OrderType side, uint32_t price_cents, uint32_t qty,
+                        TimeInForce tif = TimeInForce::GTC, OrderKind kind = OrderKind::LIMIT) {
+    Order o(id, "BENCH", side, 0.0, qty, tif, kind);
+    o.price_cents = price_cents;
+    return o;
+}
+
+static double elapsed_ns(bench_clock::time_point start) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count());
+}
+
+// Cascading stops: n ask levels of 100 shares from base upwards and n buy stops.
+// "chain": one stop per level, each activation lifts the next level and fires the next stop.
+// "burst": every stop sits in the base bucket and fires on the first trade.
+static void bench_stop_cascade(size_t n, bool chain) {
+    const uint32_t base = 10000;
+    const int runs = 5;
+    double best = 1e18;
+    uint64_t fired = 0, cascade = 0;
+    for (int run = 0; run < runs; ++run) {
+        MatchingEngine engine(MatchingEngine::Config{});
+        std::vector<Order> setup;
+        std::vector<ExecReport> out;
+        uint64_t id = 1;
+        for (size_t i = 0; i < n; ++i) setup.push_back(make_order(id++, OrderType::SELL, base + static_cast<uint32_t>(i), 100));
+        for (size_t i = 0; i < n; ++i) {
+            Order s = make_order(id++, OrderType::BUY, 0, 100, TimeInForce::IOC, OrderKind::STOP);
+            s.stop_price_cents = chain ? base + static_cast<uint32_t>(i) : base;
+            setup.push_back(s);
+        }
+        engine.process(setup.data(), setup.size(), out);
+        out.clear();
+        out.reserve(8 * n + 16);
+        Order spark = make_order(id++, OrderType::BUY, base, 1, TimeInForce::IOC);
+        auto start = bench_clock::now();
+        engine.process(&spark, 1, out);
+        best = std::min(best, elapsed_ns(start));
+        fired = engine.stats().stops_triggered;
+        cascade = engine.stats().max_cascade;
+    }
+    std::cout << "  " << (chain ? "chain" : "burst") << " n=" << std::setw(5) << n
+              << ": fired " << std::setw(5) << fired << ", largest cascade " << std::setw(5) << cascade
+              << ", total " << std::fixed << std::setprecision(1) << best / 1000.0 << "us, "
+              << best / std::max<uint64_t>(fired, 1) << "ns/stop\n";
+}
+
+// Call auction: n random limit orders within +/-5.00 of 100.00 rest in auction mode, then
+// time the equilibrium search alone and the full uncross (search plus executions).
+static void bench_uncross(size_t n) {
+    const int runs = 5;
+    double best_eq = 1e18, best_full = 1e18;
+    UncrossResult result;
+    for (int run = 0; run < runs; ++run) {
+        OrderBook book(5000, 25000, n);
+        book.set_auction(true);
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<uint32_t> px(9500, 10500);
+        std::uniform_int_distribution<uint32_t> qty(1, 1000);
+        for (size_t i = 0; i < n; ++i)
+            book.add(make_order(i + 1, (gen() & 1) ? OrderType::SELL : OrderType::BUY, px(gen), qty(gen)), [](const Fill&) {});
+        auto start = bench_clock::now();
+        result = book.equilibrium(10000);
+        best_eq = std::min(best_eq, elapsed_ns(start));
+        uint64_t fills = 0;
+        start = bench_clock::now();
+        book.uncross(10000, [&](const Fill&) { fills++; });
+        best_full = std::min(best_full, elapsed_ns(start));
+    }
+    std::cout << "  orders=" << std::setw(6) << n << ": price " << result.price_cents << ", volume " << result.volume
+              << ", imbalance " << result.imbalance << ", equilibrium " << std::fixed << std::setprecision(1)
+              << best_eq / 1000.0 << "us, full uncross " << best_full / 1000.0 << "us\n";
+}
+
+// Continuous matching cost per order for the same random flow (prices within +/-0.50
+// of 100.00, 30% IOC) in plain limit form and with STP accounts and/or icebergs added.
+enum class Flow { PLAIN, STP_CANCEL_OLDEST, STP_DECREMENT, ICEBERG, STP_ICEBERG };
+
+static void bench_flow(Flow flow, const char* name) {
+    const size_t n = 200000;
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<uint32_t> px(9950, 10050);
+    std::uniform_int_distribution<uint32_t> qty(1, 1000);
+    std::uniform_int_distribution<int> pct(0, 99);
+    std::vector<Order> orders;
+    orders.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        Order o = make_order(i + 1, (gen() & 1) ? OrderType::SELL : OrderType::BUY, px(gen), qty(gen),
+                             pct(gen) < 30 ? TimeInForce::IOC : TimeInForce::GTC);
+        o.account_id = 1 + gen() % 8;
+        bool stp = flow == Flow::STP_CANCEL_OLDEST || flow == Flow::STP_DECREMENT || flow == Flow::STP_ICEBERG;
+        if (stp) o.stp = flow == Flow::STP_DECREMENT ? StpMode::DECREMENT : StpMode::CANCEL_OLDEST;
+        bool iceberg = flow == Flow::ICEBERG || flow == Flow::STP_ICEBERG;
+        if (iceberg && pct(gen) < 30 && o.quantity >= 10) o.display_qty = o.quantity / 10;
+        orders.push_back(o);
+    }
+    OrderBook book(5000, 25000, n);
+    uint64_t fills = 0, prevented = 0;
+    LatencyHistogram per_order;
+    auto start = bench_clock::now();
+    for (const Order& o : orders) {
+        auto t0 = bench_clock::now();
+        book.add(o, [&](const Fill& f) { if (f.self_trade) prevented++; else fills++; });
+        per_order.record(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - t0).count());
+    }
+    double total = elapsed_ns(start);
+    std::cout << "  " << std::left << std::setw(18) << name << std::right << ": " << std::fixed << std::setprecision(1)
+              << total / n << "ns/order, p50 " << per_order.percentile(50) << "ns, p99 " << per_order.percentile(99)
+              << "ns, fills " << fills << ", self-trades prevented " << prevented << "\n";
+}
+
+// Cumulative-volume scan over a full 20001-level ladder.
+static void bench_prefix_sum() {
+    const size_t n = 20001;
+    const int reps = 2000;
+    std::vector<uint64_t> src(n), work(n);
+    std::mt19937_64 gen(3);
+    for (auto& v : src) v = gen() % 1000;
+    double scalar = 0, simd = 0;
+    for (int r = 0; r < reps; ++r) {
+        work = src;
+        auto start = bench_clock::now();
+        inclusive_prefix_sum_scalar(work.data(), n);
+        scalar += elapsed_ns(start);
+        uint64_t check = work.back();
+        work = src;
+        start = bench_clock::now();
+        inclusive_prefix_sum(work.data(), n);
+        simd += elapsed_ns(start);
+        if (work.back() != check) { std::cout << "  prefix sum mismatch\n"; return; }
+    }
+    std::cout << "  prefix sum over " << n << " levels: scalar " << std::fixed << std::setprecision(2)
+              << scalar / reps / 1000.0 << "us, vectorized " << simd / reps / 1000.0 << "us\n";
+}
+
+// Bar/VWAP fold rate: 10M prints over 32 symbols, published in chunks of 4096 and
+// drained by one BarAggregator on the same core; 1ms of tape time per chunk so bars close.
+static void bench_bar_aggregator() {
+    const size_t n = 10000000, chunk = 4096, symbols = 32;
+    BroadcastRing<TradePrint> tape(1 << 13);
+    BarAggregator bars(tape, symbols, 0);
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<uint32_t> sym(0, symbols - 1), px(9900, 10099), qty(1, 500);
+    std::vector<TradePrint> prints(chunk);
+    uint64_t ts = 0, closed = 0;
+    double fold = 0;
+    for (size_t done = 0; done < n; done += chunk) {
+        for (auto& t : prints) t = TradePrint{ts, sym(gen), px(gen), qty(gen)};
+        ts += 1000000;
+        for (const auto& t : prints) tape.publish(t);
+        auto start = bench_clock::now();
+        bars.poll(ts, [&](size_t, uint32_t, const Bar&) { closed++; });
+        fold += elapsed_ns(start);
+    }
+    std::cout << "  " << n << " prints: " << std::fixed << std::setprecision(2) << fold / n << "ns/print ("
+              << std::setprecision(1) << n / fold * 1000.0 << "M prints/s), bars closed " << closed
+              << ", missed " << bars.stats().missed << "\n";
+}
+
+// Position keeping: 10M fills between random accounts (of 256) over 32 symbols, then
+// one valuation sweep over every account.
+static void bench_positions() {
+    const size_t n = 10000000, accounts = 256, symbols = 32;
+    PositionKeeper keeper(accounts, symbols);
+    std::mt19937 gen(9);
+    std::uniform_int_distribution<uint32_t> acct(1, accounts - 1), sym(0, symbols - 1), px(9900, 10099), qty(1, 500);
+    struct F { uint32_t sym, buy, sell, qty, px; };
+    std::vector<F> fills(n);
+    for (auto& f : fills) f = F{sym(gen), acct(gen), acct(gen), qty(gen), px(gen)};
+    auto start = bench_clock::now();
+    for (const F& f : fills) keeper.on_fill(f.sym, f.buy, f.sell, f.qty, f.px);
+    double apply = elapsed_ns(start);
+    start = bench_clock::now();
+    int64_t gross = 0;
+    for (uint32_t a = 1; a < accounts; ++a) gross += keeper.exposure(a).gross_cents;
+    double sweep = elapsed_ns(start);
+    std::cout << "  " << n << " fills: " << std::fixed << std::setprecision(2) << apply / n << "ns/fill, snapshot + valuation "
+              << sweep / (accounts - 1) << "ns/account (gross $" << std::setprecision(0) << gross / 100.0 << ")\n";
+}
+
+// Routing decision cost: 1M random orders against 2 and 4 venues under each policy.
+static void bench_router(size_t venues, RoutePolicy policy, const char* name) {
+    const size_t n = 1000000;
+    std::vector<VenueProfile> profiles;
+    for (size_t v = 0; v < venues; ++v) {
+        VenueProfile p;
+        p.name = "V" + std::to_string(v);
+        // Cheaper venues are slower and fill large orders less often.
+        p.fee_mils_per_share = 250 - 50 * static_cast<int32_t>(v);
+        p.latency_ns = 50000 + 20000 * v;
+        p.fill_prob = VenueProfile::fill_table(64000, static_cast<uint16_t>(1600 + 800 * v));
+        profiles.push_back(p);
+    }
+    OrderRouter router(profiles, policy);
+    std::mt19937 gen(13);
+    std::uniform_int_distribution<uint32_t> qty(1, 1000);
+    std::vector<Order> orders;
+    orders.reserve(n);
+    for (size_t i = 0; i < n; ++i) orders.push_back(make_order(i + 1, (gen() & 1) ? OrderType::SELL : OrderType::BUY, 10000, qty(gen)));
+    std::vector<uint64_t> routed(venues);
+    auto start = bench_clock::now();
+    for (const Order& o : orders) routed[router.route(o)]++;
+    double total = elapsed_ns(start);
+    std::cout << "  " << venues << " venues, " << std::left << std::setw(16) << name << std::right << ": "
+              << std::fixed << std::setprecision(2) << total / n << "ns/decision, split";
+    for (uint64_t r : routed) std::cout << " " << r;
+    std::cout << "\n";
+}
+
+// A/B arbitration: 10M sequenced messages on two lines with 2% independent loss each,
+// B trailing A by a few messages, merged into one stream.
+static void bench_feed_arbiter() {
+    const uint64_t n = 10000000;
+    const uint64_t lag = 3;
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> pct(0, 9999);
+    struct Msg { uint8_t line; uint64_t seq; };
+    std::vector<Msg> msgs;
+    msgs.reserve(2 * n);
+    for (uint64_t seq = 1; seq <= n + lag; ++seq) {
+        if (seq <= n && pct(gen) >= 200) msgs.push_back(Msg{0, seq});
+        if (seq > lag && pct(gen) >= 200) msgs.push_back(Msg{1, seq - lag});
+    }
+    FeedArbiter arbiter;
+    Order o = make_order(1, OrderType::BUY, 10000, 100);
+    uint64_t out = 0;
+    auto start = bench_clock::now();
+    for (const Msg& m : msgs) arbiter.on_message(m.line, m.seq, o, [&](const Order&) { out++; });
+    double total = elapsed_ns(start);
+    const ArbiterStats& s = arbiter.stats();
+    std::cout << "  " << msgs.size() << " messages: " << std::fixed << std::setprecision(2) << total / msgs.size()
+              << "ns/message, delivered " << out << ", recovered " << s.recovered() << ", lost " << s.lost
+              << " in " << s.unrecoverable_gaps << " gaps, duplicates " << s.duplicates << "\n";
+}
+
+// Reorder window sizing: one datagram every 10us, 1% lost, 2% overtaken by 1..8 later
+// ones, 0.5% duplicated. Arrival order is replayed through the buffer in virtual time.
+static void bench_reorder_buffer(size_t window, uint64_t max_hold_us) {
+    const uint64_t n = 2000000, interval_ns = 10000;
+    std::mt19937 gen(23);
+    std::uniform_int_distribution<int> pct(0, 9999);
+    std::uniform_int_distribution<uint64_t> depth(1, 8);
+    struct Arrival { uint64_t ts_ns, seq; };
+    std::vector<Arrival> arrivals;
+    arrivals.reserve(n + n / 100);
+    for (uint64_t seq = 1; seq <= n; ++seq) {
+        if (pct(gen) < 100) continue;
+        uint64_t ts = seq * interval_ns;
+        // Overtaken datagrams land just after the k-th later one
+        if (pct(gen) < 200) ts += depth(gen) * interval_ns + 1;
+        arrivals.push_back({ts, seq});
+        if (pct(gen) < 50) arrivals.push_back({ts + depth(gen) * interval_ns + 1, seq});
+    }
+    std::stable_sort(arrivals.begin(), arrivals.end(), [](const Arrival& a, const Arrival& b) { return a.ts_ns < b.ts_ns; });
+    ReorderBuffer<uint64_t> buffer(window, max_hold_us * 1000);
+    LatencyHistogram hold;
+    uint64_t out = 0;
+    auto emit = [&](uint64_t, uint64_t held_ns) { out++; if (held_ns) hold.record(held_ns); };
+    auto start = bench_clock::now();
+    for (const Arrival& a : arrivals) buffer.push(a.seq, a.ts_ns, a.seq, emit);
+    double total = elapsed_ns(start);
+    buffer.flush(arrivals.back().ts_ns, emit);   // untimed: whatever the last gaps still hold
+    const ReorderBufferStats& s = buffer.stats();
+    std::cout << "  window " << std::setw(3) << window << ", hold " << std::setw(4) << max_hold_us << "us: " << std::fixed
+              << std::setprecision(2) << total / arrivals.size() << "ns/datagram, delivered " << out << ", late " << s.late
+              << ", lost " << s.lost << ", overflows " << s.window_overflows << ", hold p99 " << std::setprecision(1)
+              << hold.percentile(99) / 1000.0 << "us\n";
+}
+
+// Shaper cost per batch: batches of 10 offered every interval_ns against a 1M msgs/s
+// limit (burst 16). Above the limit, held batches merge into 64-order messages. Only
+// the submit()/poll() calls are timed, in TSC ticks.
+static void bench_rate_shaper(uint64_t interval_ns) {
+    ShaperConfig cfg;
+    cfg.msgs_per_sec = 1e6;
+    cfg.bytes_per_sec = 1e10;
+    uint64_t sent = 0;
+    RateShaper shaper(cfg, [&](const std::vector<Order>& b, uint64_t) { sent += b.size(); });
+    std::vector<Order> batch(10, make_order(1, OrderType::BUY, 10000, 100));
+    const int n = 200000;
+    uint64_t interval = static_cast<uint64_t>(interval_ns * tsc_ticks_per_ns()), busy = 0;
+    uint64_t next = tsc_now();
+    for (int i = 0; i < n; ++i) {
+        while (tsc_now() < next) {}
+        next += interval;
+        uint64_t t0 = tsc_now();
+        shaper.submit(batch, 0);
+        shaper.poll();
+        busy += tsc_now() - t0;
+    }
+    shaper.drain();   // untimed: whatever is still held at the end
+    ShaperStats s = shaper.stats();
+    std::cout << "  every " << std::setw(4) << interval_ns << "ns: " << std::fixed << std::setprecision(2)
+              << static_cast<double>(tsc_to_ns(busy)) / n << "ns/batch, " << s.sent_msgs << " messages for " << sent
+              << " orders, " << s.merged << " merged, shaping p99 " << std::setprecision(1)
+              << s.delay_ns.percentile(99) / 1000.0 << "us\n";
+}
+
+// DRR service cost and shares: client 1 keeps its queue full, the others offer one
+// order per round each; the ring drains 8 orders per round, so it is the bottleneck.
+// Light clients should always get what they offer and the flooder only the remainder.
+static void bench_fair_ingress(size_t clients) {
+    OrderRingBuffer ring(64);
+    FairIngress ingress(ring, clients, 1024, 4);
+    Order o = make_order(1, OrderType::BUY, 10000, 100);
+    std::vector<uint64_t> served(clients + 1, 0);
+    const int rounds = 1000000;
+    uint64_t forwarded = 0;
+    double busy = 0;
+    for (int r = 0; r < rounds; ++r) {
+        o.client_id = 1;
+        while (ingress.try_push(o)) {}
+        for (uint16_t c = 2; c <= clients; ++c) { o.client_id = c; ingress.try_push(o); }
+        auto start = bench_clock::now();
+        forwarded += ingress.service();
+        busy += elapsed_ns(start);
+        Order out;
+        for (int i = 0; i < 8 && ring.try_pop(out); ++i) served[out.client_id]++;
+    }
+    std::cout << "  " << clients << " clients: " << std::fixed << std::setprecision(2) << busy / forwarded
+              << "ns/order forwarded, shares";
+    uint64_t total = 0;
+    for (uint16_t c = 1; c <= clients; ++c) total += served[c];
+    for (uint16_t c = 1; c <= clients; ++c) std::cout << " " << std::setprecision(1) << 100.0 * served[c] / total << "%";
+    std::cout << "\n";
+}
+
+// Loopback UDP order entry into 1..N SO_REUSEPORT receivers: 16 clients on 4 sender
+// threads send as fast as they can; throughput counts orders decoded into the rings
+// until the receivers go idle. Datagrams the socket buffers overflowed are lost.
+static void bench_reuseport_ingress(int receivers) {
+    const size_t clients = 16;
+    const uint64_t per_client = 6000;
+    std::vector<std::unique_ptr<AdaptiveRingBuffer>> rings;
+    std::vector<AdaptiveRingBuffer*> outs;
+    for (int r = 0; r < receivers; ++r) {
+        rings.push_back(std::make_unique<AdaptiveRingBuffer>(1 << 17));
+        outs.push_back(rings.back().get());
+    }
+    ReuseportIngress ingress(INGRESS_PORT, outs, clients);
+    if (!ingress.start()) {
+        std::cout << "  cannot bind port " << INGRESS_PORT << "\n";
+        return;
+    }
+    std::vector<IngressSender> senders(clients);
+    for (IngressSender& s : senders) s.open(INGRESS_PORT);
+    auto start = bench_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t)
+        threads.emplace_back([&, t] {
+            Order o = make_order(1, OrderType::BUY, 10000, 100);
+            for (uint64_t i = 0; i < per_client; ++i)
+                for (size_t c = t; c < clients; c += 4) {
+                    o.client_id = static_cast<uint16_t>(c + 1);
+                    senders[c].send(o);
+                }
+        });
+    for (auto& t : threads) t.join();
+    uint64_t last = ingress.received();
+    double busy = elapsed_ns(start);
+    for (int idle = 0; idle < 50; ++idle) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        uint64_t now = ingress.received();
+        if (now != last) { last = now; busy = elapsed_ns(start); idle = 0; }
+    }
+    ingress.stop();
+    ReuseportIngressStats s = ingress.stats();
+    uint64_t reordered = 0;
+    std::cout << "  " << receivers << " receiver" << (receivers > 1 ? "s" : " ") << ": " << std::fixed << std::setprecision(0)
+              << last / (busy / 1e9) / 1000.0 << "k orders/s, " << std::setprecision(1)
+              << 100.0 * (clients * per_client - last) / (clients * per_client) << "% lost, clients per receiver";
+    for (const ReceiverStats& r : s.receivers) {
+        std::cout << " " << r.clients;
+        reordered += r.reordered;
+    }
+    std::cout << ", " << s.split_clients << " split, " << reordered << " reordered\n";
+}
+
+// UDP ping-pong over loopback against a blocking echo thread, one ping every 100us. The
+// pinger waits for each echo in the given receive mode; CPU is the pinger thread's
+// CPU time over the run (the pauses between pings count as idle).
+static void bench_recv_mode(RecvMode mode) {
+    int echo_fd = socket(AF_INET, SOCK_DGRAM, 0), fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = loopback_addr(0);
+    bind(echo_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    addr = loopback_addr(local_port(echo_fd));
+    connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    set_recv_timeout(echo_fd, 100);
+    std::atomic<bool> running{true};
+    std::thread echo([&] {
+        char buf[64];
+        sockaddr_in from{};
+        while (running) {
+            socklen_t len = sizeof(from);
+            ssize_t n = recvfrom(echo_fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &len);
+            if (n > 0) sendto(echo_fd, buf, static_cast<size_t>(n), 0, reinterpret_cast<sockaddr*>(&from), len);
+        }
+    });
+    set_recv_timeout(fd, 100);
+    SocketWaiter wait;
+    wait.setup(fd, mode, 50);
+    LatencyHistogram rtt;
+    const int pings = 5000;
+    uint64_t cpu0 = thread_cpu_ns(pthread_self());
+    auto start = bench_clock::now();
+    for (int i = 0; i < pings; ++i) {
+        uint64_t t0 = wire_now_ns(), got = 0;
+        send(fd, &t0, sizeof(t0), 0);
+        while (recv(fd, &got, sizeof(got), wait.recv_flags()) != static_cast<ssize_t>(sizeof(got))) wait.on_empty();
+        wait.on_data();
+        rtt.record(wire_now_ns() - t0);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    double wall = elapsed_ns(start);
+    RecvWaitStats s = wait.get_stats(thread_cpu_ns(pthread_self()) - cpu0, static_cast<uint64_t>(wall));
+    running = false;
+    echo.join();
+    close(fd);
+    close(echo_fd);
+    std::cout << "  " << std::left << std::setw(9) << s.mode << std::right << ": RTT p50 " << std::fixed << std::setprecision(1)
+              << rtt.percentile(50) / 1000.0 << "us, p99 " << rtt.percentile(99) / 1000.0 << "us, pinger CPU " << s.cpu_pct
+              << "%, " << s.empty_polls << " empty polls, " << s.parks << " parks"
+              << (s.kernel_busy_poll ? ", SO_BUSY_POLL" : "") << "\n";
+}
+
+// Hot-path cost of a LOG_* call into the calling thread's ring, written to /dev/null.
+// Calls come in bursts of 500 (well inside the ring) with a pause for the writer
+// between bursts (longer than its idle sleep); only the calls are timed.
+static void bench_async_logger() {
+    AsyncLogger& logger = AsyncLogger::instance();
+    logger.start("/dev/null");
+    const int bursts = 400, per_burst = 500;
+    double busy_int = 0, busy_mixed = 0;
+    for (int b = 0; b < bursts; ++b) {
+        auto start = bench_clock::now();
+        for (int i = 0; i < per_burst; ++i) LOG_INFO("seq {} qty {}", static_cast<uint64_t>(i), b);
+        busy_int += elapsed_ns(start);
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        start = bench_clock::now();
+        for (int i = 0; i < per_burst; ++i) LOG_WARN("order {} px {} sym {}", static_cast<uint64_t>(i), 101.25, "BENCH");
+        busy_mixed += elapsed_ns(start);
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+    }
+    logger.stop();
+    std::cout << "  two integers: " << std::fixed << std::setprecision(2) << busy_int / (bursts * per_burst)
+              << "ns/call, integer+double+string: " << busy_mixed / (bursts * per_burst) << "ns/call, written "
+              << logger.written() << ", dropped " << logger.dropped() << "\n";
+}
+
+// Capture cost on the sending thread for 10-order batch frames, then the read back.
+static void bench_pcap_capture() {
+    const char* path = "book_bench.pcap";
+    std::vector<Order> orders;
+    for (uint64_t i = 0; i < 10; ++i) orders.push_back(make_order(i, OrderType::BUY, 100.0, 100));
+    std::vector<char> frame;
+    encode_frame(MsgType::ORDER_BATCH, 1, 0, orders.data(), orders.size(), frame);
+    const int bursts = 200, per_burst = 250;
+    double busy = 0;
+    uint64_t written = 0, dropped = 0;
+    {
+        PcapWriter writer;
+        if (!writer.open(path)) return;
+        for (int b = 0; b < bursts; ++b) {
+            auto start = bench_clock::now();
+            for (int i = 0; i < per_burst; ++i)
+                writer.write(pcap_now_ns(), i & 1 ? PCAP_PROTO_TCP : PCAP_PROTO_UDP, 50000, VENUE_UDP_PORT, frame.data(), frame.size());
+            busy += elapsed_ns(start);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        writer.close();
+        written = writer.stats().frames;
+        dropped = writer.stats().dropped;
+    }
+    PcapReader reader;
+    PcapFrame f;
+    WireHeader hdr;
+    uint64_t frames = 0, decoded = 0;
+    auto start = bench_clock::now();
+    if (reader.open(path))
+        while (reader.next(f)) {
+            frames++;
+            if (decode_frame(f.payload.data(), f.payload.size(), MsgType::ORDER_BATCH, hdr, orders)) decoded++;
+        }
+    double read_ns = elapsed_ns(start);
+    std::remove(path);
+    std::cout << "  " << frame.size() << "B frames: write " << std::fixed << std::setprecision(2)
+              << busy / (bursts * per_burst) << "ns/frame (" << written << " written, " << dropped << " dropped), read "
+              << read_ns / std::max<uint64_t>(1, frames) << "ns/frame (" << decoded << "/" << frames << " decoded)\n";
+}
+
+// Pre-trade reads of a registry + limits pair that a writer republishes every 100us:
+// epoch-protected pointers vs a mutex vs atomic shared_ptr loads. NONE reads unguarded
+// with no writer, as the floor.
+enum class RefGuard { NONE, EPOCH, MUTEX, SHARED_PTR };
+
+static void bench_reference_reads(RefGuard guard, int readers) {
+    static const char* names[] = {"unguarded", "epoch", "mutex", "shared_ptr"};
+    auto make_registry = [] {
+        auto r = std::make_unique<InstrumentRegistry>();
+        for (const char* sym : {"AAPL", "GOOGL", "MSFT", "BENCH"}) r->add(sym);
+        return r;
+    };
+    EpochManager epochs;
+    EpochPtr<InstrumentRegistry> ebr_reg(epochs, make_registry());
+    EpochPtr<RiskLimits> ebr_lim(epochs, std::make_unique<RiskLimits>());
+    std::mutex mutex;
+    std::unique_ptr<InstrumentRegistry> mx_reg = make_registry();
+    std::unique_ptr<RiskLimits> mx_lim = std::make_unique<RiskLimits>();
+    std::shared_ptr<const InstrumentRegistry> sp_reg = make_registry();
+    std::shared_ptr<const RiskLimits> sp_lim = std::make_shared<RiskLimits>();
+
+    const uint64_t reads = 2000000;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> accepted{0};
+    uint64_t updates = 0;
+    std::thread writer([&] {
+        bool tight = false;
+        while (guard != RefGuard::NONE && !done.load()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            tight = !tight;
+            auto reg = make_registry();
+            reg->find("GOOGL")->halted = tight;
+            auto lim = std::make_unique<RiskLimits>();
+            lim->max_notional_cents = tight ? 10000000 : 15000000;
+            if (guard == RefGuard::EPOCH) {
+                ebr_reg.store(std::move(reg));
+                ebr_lim.store(std::move(lim));
+            } else if (guard == RefGuard::MUTEX) {
+                std::lock_guard<std::mutex> lock(mutex);
+                mx_reg.swap(reg);
+                mx_lim.swap(lim);
+            } else {
+                std::atomic_store(&sp_reg, std::shared_ptr<const InstrumentRegistry>(std::move(reg)));
+                std::atomic_store(&sp_lim, std::shared_ptr<const RiskLimits>(std::move(lim)));
+            }
+            updates++;
+        }
+    });
+    auto read = [&](int id) {
+        EpochManager::Participant epoch(epochs);
+        Order o = make_order(static_cast<uint64_t>(id), OrderType::BUY, 15000, 1);
+        uint64_t ok = 0;
+        for (uint64_t i = 0; i < reads; ++i) {
+            o.quantity = static_cast<uint32_t>(1 + (i & 1023));
+            PreTradeResult r;
+            if (guard == RefGuard::EPOCH) {
+                epoch.announce();
+                r = pre_trade_check(o, *ebr_reg.load(), *ebr_lim.load());
+            } else if (guard == RefGuard::MUTEX) {
+                std::lock_guard<std::mutex> lock(mutex);
+                r = pre_trade_check(o, *mx_reg, *mx_lim);
+            } else if (guard == RefGuard::SHARED_PTR) {
+                auto reg = std::atomic_load(&sp_reg);
+                auto lim = std::atomic_load(&sp_lim);
+                r = pre_trade_check(o, *reg, *lim);
+            } else {
+                r = pre_trade_check(o, *mx_reg, *mx_lim);
+            }
+            ok += r == PreTradeResult::ACCEPT;
+        }
+        accepted += ok;
+    };
+    auto start = bench_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < readers; ++i) threads.emplace_back(read, i);
+    for (auto& t : threads) t.join();
+    double ns = elapsed_ns(start);
+    done = true;
+    writer.join();
+    std::cout << "  " << std::setw(10) << names[static_cast<int>(guard)] << ", " << readers << " reader"
+              << (readers > 1 ? "s" : " ") << ": " << std::fixed << std::setprecision(2) << ns / (reads * readers)
+              << "ns/check (" << updates << " updates";
+    if (guard == RefGuard::EPOCH) std::cout << ", " << epochs.freed() << "/" << epochs.retired() << " versions freed";
+    std::cout << ", " << accepted << " accepted)\n";
+}
+
+// Test-and-test-and-set lock with a yield fallback, as the spinlock baseline.
+class SpinLock {
+    std::atomic<bool> locked_{false};
+public:
+    void lock() {
+        for (int spins = 0; locked_.load(std::memory_order_relaxed) || locked_.exchange(true, std::memory_order_acquire); ++spins)
+            if (spins >= 64) std::this_thread::yield();
+    }
+    void unlock() { locked_.store(false, std::memory_order_release); }
+};
+
+// One batch sequence fed by several threads: a mutex or a spinlock around a plain
+// Batcher vs flat combining. The send is a counter, so this is the synchronization cost.
+enum class BatchSync { MUTEX, SPINLOCK, COMBINING };
+
+static void bench_shared_batcher(BatchSync sync, int threads) {
+    static const char* names[] = {"mutex", "spinlock", "combining"};
+    const uint64_t per_thread = 500000;
+    uint64_t batches = 0, sent = 0;
+    Batcher::SendFn send = [&](const std::vector<Order>& batch, uint64_t) {
+        batches++;
+        sent += batch.size();
+    };
+    Batcher plain(10, std::chrono::microseconds(1000), send);
+    CombiningBatcher combining(10, std::chrono::microseconds(1000), send);
+    std::mutex mutex;
+    SpinLock spin;
+    auto add = [&](int id) {
+        Order o = make_order(0, OrderType::BUY, 10000, 100);
+        o.client_id = static_cast<uint16_t>(id);
+        for (uint64_t i = 0; i < per_thread; ++i) {
+            o.order_id = i;
+            if (sync == BatchSync::MUTEX) {
+                std::lock_guard<std::mutex> lock(mutex);
+                plain.add_order(o);
+            } else if (sync == BatchSync::SPINLOCK) {
+                std::lock_guard<SpinLock> lock(spin);
+                plain.add_order(o);
+            } else {
+                combining.add_order(o);
+            }
+        }
+    };
+    auto start = bench_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) workers.emplace_back(add, i);
+    for (auto& t : workers) t.join();
+    double ns = elapsed_ns(start);
+    uint64_t total = per_thread * static_cast<uint64_t>(threads);
+    std::cout << "  " << std::setw(9) << names[static_cast<int>(sync)] << ", " << threads << " thread"
+              << (threads > 1 ? "s" : " ") << ": " << std::fixed << std::setprecision(2) << total * 1e3 / ns
+              << "M orders/s (" << sent << "/" << total << " in " << batches << " batches";
+    if (sync == BatchSync::COMBINING) {
+        CombiningStats cs = combining.stats();
+        std::cout << ", " << static_cast<double>(cs.orders) / std::max<uint64_t>(1, cs.passes) << " orders/pass";
+    }
+    std::cout << ")\n";
+}
+
+// Producer idle point: the adaptive ring needs its pending pushes published. Returns
+// whether anything was still unpublished.
+template <typename Ring>
+static bool flush_ring(Ring& ring) {
+    if constexpr (std::is_same_v<Ring, AdaptiveRingBuffer>) return ring.flush();
+    else return (void)ring, false;
+}
+
+// SPSC throughput: 4M orders from a producer thread to a consumer thread through a
+// 1024-slot ring; either side yields when the ring is full or empty. Index stores per
+// order are shown for the adaptive ring; the eager rings always make two. The consumer
+// checks each order id against the next one pushed and reports any that differ.
+template <typename Ring>
+static void bench_spsc_throughput(const char* name) {
+    const uint64_t n = 4000000;
+    Ring ring(1024);
+    uint64_t push_fail = 0, pop_fail = 0, mismatched = 0;
+    auto start = bench_clock::now();
+    std::thread consumer([&] {
+        Order o;
+        for (uint64_t got = 0; got < n;) {
+            if (ring.try_pop(o)) {
+                mismatched += o.order_id != got;
+                got++;
+            } else {
+                pop_fail++;
+                std::this_thread::yield();
+            }
+        }
+    });
+    Order o = make_order(0, OrderType::BUY, 10000, 100);
+    for (uint64_t i = 0; i < n; ++i) {
+        o.order_id = i;
+        while (!ring.try_push(o)) {
+            push_fail++;
+            std::this_thread::yield();
+        }
+    }
+    flush_ring(ring);
+    consumer.join();
+    double ns = elapsed_ns(start);
+    std::cout << "  " << std::setw(12) << name << ": " << std::fixed << std::setprecision(2) << n * 1e3 / ns
+              << "M orders/s (" << push_fail << " full, " << pop_fail << " empty polls";
+    if constexpr (std::is_same_v<Ring, AdaptiveRingBuffer>)
+        std::cout << ", " << static_cast<double>(ring.publications()) / n << " index stores/order";
+    if (mismatched) std::cout << ", " << mismatched << " ORDER MISMATCH";
+    std::cout << ")\n";
+}
+
+// SPSC ping-pong: an order goes out on one ring and comes back on another, 100k round
+// trips. Waiting sides spin briefly, then yield. With flush_each, each side flushes
+// after every push. Without it, a push relies on the receiver's idle flag, and a side
+// flushes only when it starts to yield while waiting for the reply. The run then
+// reports how many trips needed that late flush.
+template <typename Ring>
+static void bench_spsc_ping_pong(const char* name, bool flush_each = true) {
+    const int trips = 100000;
+    Ring ping(1024), pong(1024);
+    std::atomic<uint64_t> late_flushes{0};
+    auto wait_pop = [&](Ring& r, Ring& sent, Order& o) {
+        for (int spins = 0; !r.try_pop(o); ++spins) {
+            if (spins < 64) continue;
+            if (spins == 64 && !flush_each && flush_ring(sent)) late_flushes.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    };
+    std::thread echo([&] {
+        Order o;
+        for (int i = 0; i < trips; ++i) {
+            wait_pop(ping, pong, o);
+            while (!pong.try_push(o)) std::this_thread::yield();
+            if (flush_each) flush_ring(pong);
+        }
+        flush_ring(pong);
+    });
+    LatencyHistogram rtt;
+    Order o = make_order(0, OrderType::BUY, 10000, 100);
+    for (int i = 0; i < trips; ++i) {
+        auto start = bench_clock::now();
+        while (!ping.try_push(o)) std::this_thread::yield();
+        if (flush_each) flush_ring(ping);
+        wait_pop(pong, ping, o);
+        rtt.record(static_cast<uint64_t>(elapsed_ns(start)));
+    }
+    echo.join();
+    std::cout << "  " << std::setw(12) << name << ": RTT p50 " << rtt.percentile(50) << "ns, p99 " << rtt.percentile(99) << "ns";
+    if (!flush_each)
+        std::cout << " (" << std::fixed << std::setprecision(1) << 100.0 * late_flushes.load() / (2.0 * trips)
+                  << "% of pushes needed a late flush)";
+    std::cout << "\n";
+}
+
+// Return path: pushers send events in bursts of 16 to one consumer through the
+// intrusive MPSC queue, with pool-allocated nodes. Push is the pusher's cost per event
+// (pool acquire included); delivery is from push to pop.
+struct BenchEvent : MpscNode {
+    uint64_t pushed_ns;
+};
+
+static void bench_mpsc_return_path(int pushers) {
+    const uint64_t per_pusher = 100000;
+    const uint64_t total = per_pusher * static_cast<uint64_t>(pushers);
+    NodePool<BenchEvent> pool(4096);
+    MpscQueue<BenchEvent> queue;
+    std::atomic<uint64_t> push_ns{0}, pool_empty{0};
+    LatencyHistogram delivery;
+    auto start = bench_clock::now();
+    std::thread consumer([&] {
+        for (uint64_t got = 0; got < total;) {
+            BenchEvent* e = queue.pop();
+            if (!e) {
+                std::this_thread::yield();
+                continue;
+            }
+            if ((got++ & 15) == 0) delivery.record(wire_now_ns() - e->pushed_ns);
+            pool.release(e);
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int p = 0; p < pushers; ++p)
+        threads.emplace_back([&] {
+            double busy = 0;
+            uint64_t empty = 0;
+            for (uint64_t i = 0; i < per_pusher; i += 16) {
+                auto t = bench_clock::now();
+                for (int k = 0; k < 16; ++k) {
+                    BenchEvent* e;
+                    while (!(e = pool.acquire())) {
+                        empty++;
+                        std::this_thread::yield();
+                    }
+                    e->pushed_ns = wire_now_ns();
+                    queue.push(e);
+                }
+                busy += elapsed_ns(t);
+                std::this_thread::yield();
+            }
+            push_ns += static_cast<uint64_t>(busy);
+            pool_empty += empty;
+        });
+    for (auto& t : threads) t.join();
+    consumer.join();
+    double ns = elapsed_ns(start);
+    std::cout << "  " << std::setw(2) << pushers << " pushers: push " << std::fixed << std::setprecision(2)
+              << static_cast<double>(push_ns) / total << "ns/event, delivery p50 " << delivery.percentile(50) / 1000.0
+              << "us p99 " << delivery.percentile(99) / 1000.0 << "us, " << total * 1e3 / ns << "M events/s ("
+              << pool_empty << " pool-empty waits)\n";
+}
+
+// Batching against a 100 Mbps bottleneck in virtual time: orders arrive every 8us (125k/s),
+// a batch leaves when full. Small batches waste the link on headers and overload the
+// queue; large ones wait to fill and fragment. Latency is per order, arrival to last bit.
+static void bench_link_batching(size_t batch, QueueDiscipline discipline) {
+    LinkConfig cfg;
+    cfg.discipline = discipline;
+    LinkModel link(cfg, UDP_HEADER_BYTES);
+    const uint64_t interval_ns = 8000, orders = 125000;
+    double latency_ns = 0;
+    uint64_t delivered = 0, batches = 0;
+    for (uint64_t first = 0; first + batch <= orders; first += batch) {
+        uint64_t now = (first + batch - 1) * interval_ns, delay = 0;
+        uint32_t packets = 0;
+        batches++;
+        if (!link.transmit_at(now, sizeof(WireHeader) + batch * sizeof(Order), delay, packets)) continue;
+        // Orders in the batch waited (batch - 1 - i) intervals for the last one to arrive
+        latency_ns += batch * (delay + (batch - 1) * interval_ns / 2.0);
+        delivered += batch;
+    }
+    LinkStats s = link.get_stats();
+    std::cout << "  batch " << std::setw(3) << batch << (discipline == QueueDiscipline::RED ? " red      " : " drop-tail")
+              << ": " << std::fixed << std::setprecision(1) << 100.0 * delivered / (batches * batch) << "% delivered, wire eff "
+              << 100.0 * s.payload_bytes / std::max<uint64_t>(1, s.wire_bytes) << "%, " << s.packets << " packets, avg latency "
+              << latency_ns / std::max<uint64_t>(1, delivered) / 1000.0 << "us, max queue " << s.max_queue_bytes << "B\n";
+}
+
+int main() {
+    std::cout << "=== Stop Trigger Cascade ===\n";
+    for (size_t n : {100, 1000, 10000}) bench_stop_cascade(n, true);
+    for (size_t n : {100, 1000, 10000}) bench_stop_cascade(n, false);
+    std::cout << "\n=== Matching Cost: STP and Iceberg vs Plain Limit ===\n";
+    bench_flow(Flow::PLAIN, "plain limit");
+    bench_flow(Flow::STP_CANCEL_OLDEST, "stp cancel-oldest");
+    bench_flow(Flow::STP_DECREMENT, "stp decrement");
+    bench_flow(Flow::ICEBERG, "iceberg 30%");
+    bench_flow(Flow::STP_ICEBERG, "stp + iceberg");
+    std::cout << "\n=== Auction Uncross ===\n";
+    bench_prefix_sum();
+    for (size_t n : {10000, 50000, 100000}) bench_uncross(n);
+    std::cout << "\n=== Bar Aggregation ===\n";
+    bench_bar_aggregator();
+    std::cout << "\n=== Positions and P&L ===\n";
+    bench_positions();
+    std::cout << "\n=== A/B Feed Arbitration ===\n";
+    bench_feed_arbiter();
+    std::cout << "\n=== UDP Reorder Buffer ===\n";
+    for (uint64_t hold_us : {20, 50, 100, 1000}) bench_reorder_buffer(64, hold_us);
+    for (size_t window : {4, 8}) bench_reorder_buffer(window, 1000);
+    std::cout << "\n=== Order Routing ===\n";
+    for (size_t venues : {2, 4}) {
+        bench_router(venues, RoutePolicy::COST, "cost");
+        bench_router(venues, RoutePolicy::LATENCY, "latency");
+        bench_router(venues, RoutePolicy::FILL_PROBABILITY, "fill probability");
+        bench_router(venues, RoutePolicy::BLENDED, "blended");
+    }
+    std::cout << "\n=== Async Logger ===\n";
+    bench_async_logger();
+    std::cout << "\n=== Pcap Capture ===\n";
+    bench_pcap_capture();
+    std::cout << "\n=== Hot-Swapped Reference Data Reads ===\n";
+    for (int readers : {1, 2})
+        for (RefGuard guard : {RefGuard::NONE, RefGuard::EPOCH, RefGuard::MUTEX, RefGuard::SHARED_PTR})
+            bench_reference_reads(guard, readers);
+    std::cout << "\n=== SPSC Ring Throughput ===\n";
+    bench_spsc_throughput<OrderRingBuffer>("shared index");
+    bench_spsc_throughput<CachedIndexRingBuffer>("cached index");
+    bench_spsc_throughput<SlotFlagRingBuffer>("slot flags");
+    bench_spsc_throughput<AdaptiveRingBuffer>("adaptive");
+    std::cout << "\n=== SPSC Ring Ping-Pong ===\n";
+    bench_spsc_ping_pong<OrderRingBuffer>("shared index");
+    bench_spsc_ping_pong<CachedIndexRingBuffer>("cached index");
+    bench_spsc_ping_pong<SlotFlagRingBuffer>("slot flags");
+    bench_spsc_ping_pong<AdaptiveRingBuffer>("adaptive");
+    bench_spsc_ping_pong<AdaptiveRingBuffer>("flag only", false);
+    std::cout << "\n=== MPSC Return Path ===\n";
+    for (int pushers : {1, 2, 8, 16}) bench_mpsc_return_path(pushers);
+    std::cout << "\n=== Shared Batcher Under Contention ===\n";
+    for (int threads : {1, 2, 4, 8})
+        for (BatchSync sync : {BatchSync::MUTEX, BatchSync::SPINLOCK, BatchSync::COMBINING})
+            bench_shared_batcher(sync, threads);
+    std::cout << "\n=== Fair Ingress (DRR) ===\n";
+    for (size_t clients : {2, 4, 8}) bench_fair_ingress(clients);
+    std::cout << "\n=== Socket Receive Modes ===\n";
+    for (RecvMode mode : {RecvMode::BLOCKING, RecvMode::BUSY_POLL, RecvMode::ADAPTIVE}) bench_recv_mode(mode);
+    std::cout << "\n=== SO_REUSEPORT Ingress Scaling ===\n";
+    std::cout << "  (" << std::thread::hardware_concurrency() << " cores)\n";
+    for (int receivers : {1, 2, 4}) bench_reuseport_ingress(receivers);
+    std::cout << "\n=== Egress Rate Shaping ===\n";
+    for (uint64_t interval_ns : {2000, 1000, 500}) bench_rate_shaper(interval_ns);
+    std::cout << "\n=== Link Batching Trade-off ===\n";
+    for (size_t batch : {1, 4, 16, 64, 256}) bench_link_batching(batch, QueueDiscipline::DROP_TAIL);
+    for (size_t batch : {1, 4}) bench_link_batching(batch, QueueDiscipline::RED);
+    std::cout << "==============================\n";
+    return 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cassert>
+#include <type_traits>
+
+// Single-producer, many-consumer broadcast ring. The producer never waits: it
+// overwrites the oldest slot, and every consumer keeps its own cursor. Each slot
+// carries a seqlock-style stamp (2*seq+1 while writing, 2*seq+2 once written), so a
+// consumer that fell more than capacity behind sees LAPPED instead of torn data.
+template <typename T>
+class BroadcastRing {
+    static_assert(std::is_trivially_copyable<T>::value, "BroadcastRing copies slots without locks");
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> stamp{0};
+        T value;
+    };
+    std::unique_ptr<Slot[]> slots_;
+    const size_t capacity_;
+    alignas(64) std::atomic<uint64_t> head_{0}; // next sequence to publish
+public:
+    enum class ReadResult { OK, EMPTY, LAPPED };
+
+    explicit BroadcastRing(size_t capacity) : capacity_(capacity) {
+        assert((capacity & (capacity - 1)) == 0 && "Capacity must be a power of 2");
+        slots_ = std::make_unique<Slot[]>(capacity);
+    }
+
+    void publish(const T& value) {
+        uint64_t seq = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[seq & (capacity_ - 1)];
+        slot.stamp.store(2 * seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value = value;
+        slot.stamp.store(2 * seq + 2, std::memory_order_release);
+        head_.store(seq + 1, std::memory_order_release);
+    }
+
+    // Reads the entry at cursor and advances it on success.
+    ReadResult read(uint64_t& cursor, T& out) const {
+        if (cursor >= head_.load(std::memory_order_acquire)) return ReadResult::EMPTY;
+        const Slot& slot = slots_[cursor & (capacity_ - 1)];
+        uint64_t expected = 2 * cursor + 2;
+        uint64_t before = slot.stamp.load(std::memory_order_acquire);
+        if (before != expected) return before > expected ? ReadResult::LAPPED : ReadResult::EMPTY;
+        out = slot.value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.stamp.load(std::memory_order_relaxed) != expected) return ReadResult::LAPPED;
+        cursor++;
+        return ReadResult::OK;
+    }
+
+    uint64_t head() const { return head_.load(std::memory_order_acquire); }
+    size_t capacity() const { return capacity_; }
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "batcher.hpp"
+
+struct CombiningStats {
+    uint64_t passes = 0;      // combiner turns that applied at least one order
+    uint64_t orders = 0;      // orders applied by a combiner
+    uint64_t max_per_pass = 0;
+};
+
+// One Batcher shared by several threads, for flows that need a single batch sequence
+// (e.g. strict per-venue ordering) rather than a batcher per thread. Flat combining:
+// add_order() publishes the order in the calling thread's own cache-line slot, and
+// whichever thread wins the combiner flag applies every pending slot to the batcher in
+// one pass, sends included. Under contention the batcher's state stays in one core's
+// cache and the other threads wait on their own slot line instead of on a shared lock.
+class CombiningBatcher {
+public:
+    static constexpr size_t MAX_THREADS = 64;
+private:
+    struct alignas(64) Slot {
+        std::atomic<bool> pending{false};
+        Order order;
+    };
+    Batcher batcher_;
+    Slot slots_[MAX_THREADS];
+    alignas(64) std::atomic<bool> combining_{false};
+    std::atomic<size_t> slots_used_{0};   // scan bound: highest thread index + 1
+    CombiningStats stats_;                // combiner only
+
+    // Dense per-thread index shared by all instances, reused once a thread exits.
+    // MAX_THREADS when every index is taken; such a thread has no slot (see add_order).
+    static size_t thread_index() {
+        static std::atomic<bool> taken[MAX_THREADS];
+        struct Index {
+            size_t i = MAX_THREADS;
+            Index() {
+                for (size_t k = 0; k < MAX_THREADS; ++k)
+                    if (!taken[k].exchange(true, std::memory_order_acq_rel)) { i = k; break; }
+            }
+            ~Index() {
+                if (i < MAX_THREADS) taken[i].store(false, std::memory_order_release);
+            }
+        };
+        thread_local Index index;
+        return index.i;
+    }
+    static void relax(int spins) {
+        if (spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            std::this_thread::yield();   // the combiner may need this core
+        }
+    }
+    bool try_lock() {
+        return !combining_.load(std::memory_order_relaxed) && !combining_.exchange(true, std::memory_order_acquire);
+    }
+    void unlock() { combining_.store(false, std::memory_order_release); }
+    // Combiner: applies every published order, slot order within a pass.
+    void combine() {
+        size_t n = slots_used_.load(std::memory_order_acquire), applied = 0;
+        for (size_t i = 0; i < n; ++i) {
+            Slot& s = slots_[i];
+            if (!s.pending.load(std::memory_order_acquire)) continue;
+            batcher_.add_order(s.order);
+            s.pending.store(false, std::memory_order_release);
+            applied++;
+        }
+        if (!applied) return;
+        stats_.passes++;
+        stats_.orders += applied;
+        if (applied > stats_.max_per_pass) stats_.max_per_pass = applied;
+    }
+    void lock() {
+        for (int spins = 0; !try_lock(); ++spins) relax(spins);
+    }
+public:
+    CombiningBatcher(size_t batch_size, std::chrono::microseconds timeout, Batcher::SendFn send)
+        : batcher_(batch_size, timeout, std::move(send)) {}
+
+    // Returns once o is in the batch (and sent, if it completed one).
+    void add_order(const Order& o) {
+        size_t i = thread_index();
+        if (i == MAX_THREADS) {
+            // No slot left: take the combiner flag like a lock and apply o directly.
+            lock();
+            combine();
+            batcher_.add_order(o);
+            stats_.passes++;
+            stats_.orders++;
+            stats_.max_per_pass = std::max<uint64_t>(stats_.max_per_pass, 1);
+            unlock();
+            return;
+        }
+        Slot& s = slots_[i];
+        size_t used = slots_used_.load(std::memory_order_relaxed);
+        while (used <= i && !slots_used_.compare_exchange_weak(used, i + 1, std::memory_order_release)) {}
+        s.order = o;
+        s.pending.store(true, std::memory_order_release);
+        for (int spins = 0; s.pending.load(std::memory_order_acquire); ++spins) {
+            if (try_lock()) {
+                combine();
+                unlock();
+            } else {
+                relax(spins);
+            }
+        }
+    }
+    bool check_timeout() {
+        lock();
+        combine();
+        bool sent = batcher_.check_timeout();
+        unlock();
+        return sent;
+    }
+    void force_flush() {
+        lock();
+        combine();
+        batcher_.force_flush();
+        unlock();
+    }
+    CombiningStats stats() {
+        lock();
+        CombiningStats s = stats_;
+        unlock();
+        return s;
+    }
+};
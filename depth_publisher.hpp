@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "broadcast_ring.hpp"
+#include "latency_histogram.hpp"
+#include "matching_engine.hpp"
+
+// Incremental L2 (price-level) market data. The matcher publishes one LevelUpdate per
+// changed level after each batch into a BroadcastRing; subscribers read at their own
+// pace, conflate only once they fall behind, and resync from the depth image if they get lapped.
+
+enum class LevelAction : uint8_t { ADD, UPDATE, DELETE };
+
+struct LevelUpdate {
+    uint64_t seq;
+    uint64_t qty;          // displayed quantity after the change (0 on DELETE)
+    uint32_t symbol_id;
+    uint32_t price_cents;
+    OrderType side;
+    LevelAction action;
+};
+
+inline LevelAction level_action(uint64_t old_qty, uint64_t new_qty) {
+    if (old_qty == 0) return LevelAction::ADD;
+    return new_qty == 0 ? LevelAction::DELETE : LevelAction::UPDATE;
+}
+
+struct DepthPublisherStats {
+    uint64_t batches = 0;
+    uint64_t updates = 0;
+    LatencyHistogram publish_ns; // drain + publish per batch with at least one change
+};
+
+class DepthPublisher {
+    // Latest displayed quantity per level, readable by any subscriber for snapshot recovery.
+    struct DepthImage {
+        std::unique_ptr<std::atomic<uint64_t>[]> bids, asks;
+        explicit DepthImage(size_t levels)
+            : bids(new std::atomic<uint64_t>[levels]()), asks(new std::atomic<uint64_t>[levels]()) {}
+    };
+    BroadcastRing<LevelUpdate> ring_;
+    std::vector<std::atomic<DepthImage*>> images_;
+    std::atomic<uint32_t> symbols_{0};
+    const uint32_t min_price_;
+    const size_t levels_;
+    DepthPublisherStats stats_;
+
+    DepthImage* image(uint32_t symbol_id) {
+        DepthImage* img = images_[symbol_id].load(std::memory_order_relaxed);
+        if (!img) {
+            img = new DepthImage(levels_);
+            images_[symbol_id].store(img, std::memory_order_release);
+        }
+        if (symbol_id >= symbols_.load(std::memory_order_relaxed)) symbols_.store(symbol_id + 1, std::memory_order_release);
+        return img;
+    }
+public:
+    DepthPublisher(const MatchingEngine::Config& cfg, size_t ring_capacity = 1 << 14)
+        : ring_(ring_capacity), images_(cfg.max_symbols), min_price_(cfg.min_price_cents),
+          levels_(cfg.max_price_cents - cfg.min_price_cents + 1) {}
+    ~DepthPublisher() {
+        for (auto& img : images_) delete img.load();
+    }
+    DepthPublisher(const DepthPublisher&) = delete;
+    DepthPublisher& operator=(const DepthPublisher&) = delete;
+
+    // Publishes every level the engine changed since the last call. Same thread as the matcher.
+    void publish(MatchingEngine& engine) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t before = stats_.updates;
+        engine.drain_depth_changes([&](uint32_t symbol_id, OrderType side, uint32_t price, uint64_t old_qty, uint64_t new_qty) {
+            DepthImage* img = image(symbol_id);
+            size_t idx = price - min_price_;
+            (side == OrderType::BUY ? img->bids : img->asks)[idx].store(new_qty, std::memory_order_release);
+            ring_.publish(LevelUpdate{ring_.head(), new_qty, symbol_id, price, side, level_action(old_qty, new_qty)});
+            stats_.updates++;
+        });
+        if (stats_.updates == before) return;
+        stats_.batches++;
+        stats_.publish_ns.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    const DepthPublisherStats& stats() const { return stats_; }
+    const BroadcastRing<LevelUpdate>& ring() const { return ring_; }
+    uint32_t symbols() const { return symbols_.load(std::memory_order_acquire); }
+    uint32_t min_price() const { return min_price_; }
+    size_t levels() const { return levels_; }
+    uint64_t image_qty(uint32_t symbol_id, OrderType side, size_t idx) const {
+        const DepthImage* img = images_[symbol_id].load(std::memory_order_acquire);
+        if (!img) return 0;
+        return (side == OrderType::BUY ? img->bids : img->asks)[idx].load(std::memory_order_acquire);
+    }
+};
+
+struct DepthSubscriberStats {
+    uint64_t received = 0;  // updates read off the ring
+    uint64_t delivered = 0; // updates handed to the handler after conflation
+    uint64_t snapshots = 0; // resyncs after being lapped
+    uint64_t conflated_polls = 0; // polls that fell too far behind and conflated
+    double conflation_ratio() const { return delivered ? static_cast<double>(received) / delivered : 0.0; }
+};
+
+// One consumer of the depth stream. A subscriber that keeps up gets every delta, in
+// sequence order. One that finds itself more than conflate_after updates behind the
+// head (or gets lapped) drains everything available instead and keeps only the latest
+// quantity per level. It then delivers just the levels that differ from what it last
+// saw, so a slow reader gets fewer, fresher updates instead of falling further behind.
+class DepthSubscriber {
+    const DepthPublisher& pub_;
+    uint64_t cursor_;
+    const uint64_t conflate_after_;
+    std::unordered_map<uint64_t, uint64_t> known_;   // level key -> qty last delivered
+    std::unordered_map<uint64_t, LevelUpdate> pending_;
+    DepthSubscriberStats stats_;
+
+    static uint64_t key(uint32_t symbol_id, OrderType side, uint32_t price) {
+        return (static_cast<uint64_t>(symbol_id) << 33) | (static_cast<uint64_t>(side) << 32) | price;
+    }
+    template <typename Handler>
+    void deliver(const LevelUpdate& u, Handler& handler) {
+        uint64_t k = key(u.symbol_id, u.side, u.price_cents);
+        auto it = known_.find(k);
+        uint64_t old_qty = it == known_.end() ? 0 : it->second;
+        if (old_qty == u.qty) return;
+        LevelUpdate out = u;
+        out.action = level_action(old_qty, u.qty);
+        if (u.qty) known_[k] = u.qty; else known_.erase(it);
+        stats_.delivered++;
+        handler(out);
+    }
+    // Jumps to the ring head and diffs the depth image against local state. Deltas read
+    // afterwards may repeat what the image already showed; they carry absolute quantities,
+    // so replaying them is harmless.
+    template <typename Handler>
+    void resync(Handler& handler) {
+        stats_.snapshots++;
+        pending_.clear();
+        cursor_ = pub_.ring().head();
+        for (uint32_t sym = 0; sym < pub_.symbols(); ++sym)
+            for (OrderType side : {OrderType::BUY, OrderType::SELL})
+                for (size_t idx = 0; idx < pub_.levels(); ++idx) {
+                    uint32_t price = static_cast<uint32_t>(idx + pub_.min_price());
+                    deliver(LevelUpdate{cursor_, pub_.image_qty(sym, side, idx), sym, price, side, LevelAction::UPDATE}, handler);
+                }
+    }
+public:
+    explicit DepthSubscriber(const DepthPublisher& pub, uint64_t conflate_after = 1024)
+        : pub_(pub), cursor_(pub.ring().head()), conflate_after_(conflate_after) {}
+
+    // Returns the number of updates delivered to handler(const LevelUpdate&).
+    template <typename Handler>
+    size_t poll(Handler&& handler) {
+        uint64_t delivered = stats_.delivered;
+        bool conflate = false;
+        LevelUpdate u;
+        for (uint64_t n = 0;; ++n) {
+            // Checked now and then, so a reader that falls behind mid-poll switches over too
+            if (!conflate && (n & 63) == 0 && pub_.ring().head() - cursor_ > conflate_after_) {
+                conflate = true;
+                stats_.conflated_polls++;
+            }
+            auto r = pub_.ring().read(cursor_, u);
+            if (r == BroadcastRing<LevelUpdate>::ReadResult::EMPTY) break;
+            if (r == BroadcastRing<LevelUpdate>::ReadResult::LAPPED) {
+                resync(handler);
+                conflate = true;
+                continue;
+            }
+            stats_.received++;
+            if (conflate) pending_[key(u.symbol_id, u.side, u.price_cents)] = u;
+            else deliver(u, handler);
+        }
+        if (pending_.empty()) return static_cast<size_t>(stats_.delivered - delivered);
+        // Latest update per level, still in sequence order
+        std::vector<LevelUpdate> latest;
+        latest.reserve(pending_.size());
+        for (const auto& kv : pending_) latest.push_back(kv.second);
+        std::sort(latest.begin(), latest.end(), [](const LevelUpdate& a, const LevelUpdate& b) { return a.seq < b.seq; });
+        for (const LevelUpdate& l : latest) deliver(l, handler);
+        pending_.clear();
+        return static_cast<size_t>(stats_.delivered - delivered);
+    }
+
+    const DepthSubscriberStats& stats() const { return stats_; }
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation for read-mostly shared structures (instrument tables, limits,
+// routing tables) that are replaced whole while hot-path threads keep reading them.
+//
+// Each reader thread owns an EpochManager::Participant and calls announce() once per
+// loop iteration. That publishes the global epoch it saw and promises it holds no
+// pointer loaded before the call. Between announcements it dereferences
+// EpochPtr<T>::load() freely: one load, no reference count, no lock. Writers swap in a
+// new object and retire the old one, which is freed once the global epoch has moved on
+// by two, i.e. every participant has announced since the swap. A reader about to block
+// for a long time should go offline() so it does not hold reclamation up.
+class EpochManager {
+public:
+    static constexpr size_t MAX_THREADS = 64;
+private:
+    static constexpr uint64_t OFFLINE = 0;
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{OFFLINE};
+        std::atomic<bool> used{false};
+    };
+    struct Retired {
+        void* p;
+        void (*free)(void*);
+        uint64_t epoch;
+    };
+    alignas(64) std::atomic<uint64_t> global_{1};
+    std::array<Slot, MAX_THREADS> slots_;
+    std::mutex mutex_;              // retired_ and counters; writers only
+    std::vector<Retired> retired_;
+    uint64_t retired_total_ = 0, freed_ = 0;
+
+    // Moves the epoch on if every online participant has seen the current one.
+    void try_advance() {
+        uint64_t g = global_.load(std::memory_order_seq_cst);
+        for (const Slot& s : slots_) {
+            if (!s.used.load(std::memory_order_acquire)) continue;
+            uint64_t e = s.epoch.load(std::memory_order_seq_cst);
+            if (e != OFFLINE && e != g) return;
+        }
+        global_.compare_exchange_strong(g, g + 1, std::memory_order_seq_cst);
+    }
+    size_t collect_locked() {
+        try_advance();
+        uint64_t g = global_.load(std::memory_order_seq_cst);
+        size_t n = 0;
+        for (size_t i = 0; i < retired_.size();) {
+            if (retired_[i].epoch + 2 <= g) {
+                retired_[i].free(retired_[i].p);
+                retired_[i] = retired_.back();
+                retired_.pop_back();
+                n++;
+            } else {
+                ++i;
+            }
+        }
+        freed_ += n;
+        return n;
+    }
+public:
+    class Participant {
+        EpochManager& mgr_;
+        Slot* slot_ = nullptr;
+    public:
+        explicit Participant(EpochManager& mgr) : mgr_(mgr) {
+            for (Slot& s : mgr.slots_) {
+                bool expected = false;
+                if (s.used.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    slot_ = &s;
+                    break;
+                }
+            }
+            if (!slot_) {
+                // Without a slot its reads would not hold reclamation back, so it cannot run safely.
+                std::fprintf(stderr, "EpochManager: more than %zu participants\n", MAX_THREADS);
+                std::abort();
+            }
+        }
+        ~Participant() {
+            slot_->epoch.store(OFFLINE, std::memory_order_release);
+            slot_->used.store(false, std::memory_order_release);
+        }
+        Participant(const Participant&) = delete;
+        Participant& operator=(const Participant&) = delete;
+
+        // Top of each reader iteration. Only a changed epoch costs a store and a fence;
+        // the fence orders the announcement before this iteration's pointer loads.
+        void announce() {
+            uint64_t g = mgr_.global_.load(std::memory_order_relaxed);
+            if (slot_->epoch.load(std::memory_order_relaxed) == g) return;
+            slot_->epoch.store(g, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+        void offline() { slot_->epoch.store(OFFLINE, std::memory_order_release); }
+    };
+
+    ~EpochManager() {
+        for (Retired& r : retired_) r.free(r.p);
+    }
+
+    // Writer side: p is already unreachable for new readers.
+    template <typename T>
+    void retire(T* p) {
+        if (!p) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        retired_.push_back(Retired{p, [](void* q) { delete static_cast<T*>(q); }, global_.load(std::memory_order_seq_cst)});
+        retired_total_++;
+        collect_locked();
+    }
+    // Frees whatever no reader can still hold; returns how many objects that was.
+    size_t collect() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return collect_locked();
+    }
+
+    uint64_t epoch() const { return global_.load(std::memory_order_relaxed); }
+    uint64_t retired() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return retired_total_;
+    }
+    uint64_t freed() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return freed_;
+    }
+};
+
+// An object replaced whole under epoch protection. Readers load() between announcements;
+// writers publish a modified copy, and the previous version is retired.
+template <typename T>
+class EpochPtr {
+    std::atomic<T*> ptr_;
+    EpochManager& mgr_;
+    std::mutex write_mutex_;
+public:
+    EpochPtr(EpochManager& mgr, std::unique_ptr<T> initial) : ptr_(initial.release()), mgr_(mgr) {}
+    ~EpochPtr() { delete ptr_.load(); }
+    EpochPtr(const EpochPtr&) = delete;
+    EpochPtr& operator=(const EpochPtr&) = delete;
+
+    // Reader. Acquire is a plain load on x86; valid until the thread's next announce().
+    const T* load() const { return ptr_.load(std::memory_order_acquire); }
+
+    void store(std::unique_ptr<T> next) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        mgr_.retire(ptr_.exchange(next.release(), std::memory_order_seq_cst));
+    }
+    // Copy, apply f, publish. Writers are serialized; readers never wait.
+    template <typename F>
+    void update(F&& f) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto next = std::make_unique<T>(*ptr_.load(std::memory_order_relaxed));
+        f(*next);
+        mgr_.retire(ptr_.exchange(next.release(), std::memory_order_seq_cst));
+    }
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "order.hpp"
+#include "ring_buffer.hpp"
+#include "latency_histogram.hpp"
+
+struct ClientIngressStats {
+    uint64_t submitted = 0;
+    uint64_t rejected = 0;       // client queue full; only this client is pushed back
+    uint64_t forwarded = 0;      // into the shared order ring
+    uint32_t quantum = 0;
+    LatencyHistogram wait_ns;    // order timestamp to forward
+};
+
+// Per-client ingress queues served into the shared order ring by deficit round-robin.
+// Each client (Order::client_id 1..clients) owns an SPSC queue that only its producer
+// pushes to, so a client that floods fills its own queue, not the ring. One scheduler
+// thread visits the backlogged clients in turn; each visit adds the client's quantum
+// to its deficit and forwards orders while the deficit covers them (one unit per
+// order). An idle client's deficit is reset, and a deficit left over because the ring
+// filled mid-visit carries to the next round, so the shares follow the quanta.
+class FairIngress {
+    struct Client {
+        OrderRingBuffer queue;
+        uint32_t quantum;
+        uint64_t deficit = 0;
+        std::atomic<uint64_t> submitted{0}, rejected{0};
+        uint64_t forwarded = 0;
+        LatencyHistogram wait_ns;
+        Client(size_t capacity, uint32_t q) : queue(capacity), quantum(q) {}
+    };
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::atomic<uint64_t> untagged_{0};   // orders with no known client_id, rejected
+    OrderRingBuffer& out_;
+    size_t next_ = 0;     // client the next round starts at
+    bool resume_ = false; // the ring filled during next_'s visit; finish it before adding a quantum
+
+    static uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+    }
+public:
+    FairIngress(OrderRingBuffer& out, size_t clients, size_t queue_capacity, uint32_t quantum = 4) : out_(out) {
+        for (size_t c = 0; c < clients; ++c) clients_.push_back(std::make_unique<Client>(queue_capacity, quantum));
+    }
+
+    // Before start: a client with quantum q gets q/(sum of quanta) of the ring when all are backlogged.
+    void set_quantum(uint16_t client_id, uint32_t quantum) { clients_[client_id - 1]->quantum = quantum; }
+
+    // Producer side; call only from client_id's own producer thread. An untagged order
+    // (client_id 0) or one from an unknown client has no queue and is rejected.
+    bool try_push(const Order& o) {
+        if (o.client_id == 0 || o.client_id > clients_.size()) {
+            untagged_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        Client& c = *clients_[o.client_id - 1];
+        c.submitted.fetch_add(1, std::memory_order_relaxed);
+        if (c.queue.try_push(o)) return true;
+        c.rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Scheduler side: one DRR round over all clients. Returns the number of orders forwarded.
+    size_t service() {
+        size_t forwarded = 0;
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            Client& c = *clients_[(next_ + i) % clients_.size()];
+            bool resumed = i == 0 && resume_;
+            resume_ = false;
+            if (c.queue.empty()) { c.deficit = 0; continue; }
+            if (!resumed) c.deficit += c.quantum;
+            uint64_t now = now_ns();
+            Order o;
+            // Only this thread pushes to out_, so a ring that is not full takes the order
+            while (c.deficit > 0 && !out_.full() && c.queue.try_pop(o)) {
+                out_.try_push(o);
+                c.deficit--;
+                c.forwarded++;
+                c.wait_ns.record(now > o.timestamp_ns ? now - o.timestamp_ns : 0);
+                forwarded++;
+            }
+            if (c.queue.empty()) c.deficit = 0;
+            if (out_.full()) {
+                resume_ = c.deficit > 0;
+                next_ = (next_ + i + (resume_ ? 0 : 1)) % clients_.size();
+                return forwarded;
+            }
+        }
+        return forwarded;
+    }
+
+    size_t clients() const { return clients_.size(); }
+    uint64_t untagged() const { return untagged_.load(std::memory_order_relaxed); }
+    // Read once the scheduler has stopped.
+    ClientIngressStats stats(uint16_t client_id) const {
+        const Client& c = *clients_[client_id - 1];
+        ClientIngressStats s;
+        s.submitted = c.submitted.load();
+        s.rejected = c.rejected.load();
+        s.forwarded = c.forwarded;
+        s.quantum = c.quantum;
+        s.wait_ns = c.wait_ns;
+        return s;
+    }
+};
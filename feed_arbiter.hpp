@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "order.hpp"
+#include "sequence_window.hpp"
+
+struct ArbiterStats {
+    std::array<uint64_t, 2> received{};   // per line
+    std::array<uint64_t, 2> first{};      // messages this line delivered before the other
+    std::array<uint64_t, 2> line_gaps{};  // sequence numbers this line skipped
+    uint64_t duplicates = 0;
+    uint64_t delivered = 0;
+    uint64_t lost = 0;                    // missing on both lines
+    uint64_t unrecoverable_gaps = 0;      // runs of lost sequence numbers
+    uint64_t window_overflows = 0;        // gaps given up because the window filled
+    uint64_t max_pending = 0;
+
+    // Line gaps the other line covered (each lost message is a gap on both lines).
+    uint64_t recovered() const {
+        uint64_t gaps = line_gaps[0] + line_gaps[1];
+        return gaps > 2 * lost ? gaps - 2 * lost : 0;
+    }
+};
+
+// A/B line arbitration for a sequenced feed (sequences start at 1). Both lines carry
+// the same stream, each in order but with independent loss. Messages are released in
+// sequence order as soon as either line has them; anything that arrives early waits
+// in a fixed window. A missing sequence is declared lost once both lines have moved
+// past it, or when the window cannot hold what arrived beyond it.
+// Single-threaded: the line handler owns it, so there is nothing to lock.
+class FeedArbiter {
+public:
+    static constexpr size_t LINES = 2;
+private:
+    SequenceWindow<Order> window_;
+    std::array<uint64_t, LINES> last_{};
+    ArbiterStats stats_;
+
+    void gap(uint64_t lost) {
+        stats_.unrecoverable_gaps++;
+        stats_.lost += lost;
+    }
+    // Releases everything now contiguous, then skips gaps both lines have passed.
+    template <typename Emit>
+    void advance(Emit& emit) {
+        auto release = [&](const Order& o) { emit(o); stats_.delivered++; };
+        for (;;) {
+            window_.release(release);
+            uint64_t passed = std::min(last_[0], last_[1]);
+            if (window_.pending() == 0 || passed <= window_.next()) return;
+            gap(window_.skip_gap(passed));
+        }
+    }
+public:
+    explicit FeedArbiter(size_t window = 4096) : window_(window) {}
+
+    // Feeds one message from line (0 = A, 1 = B); emit(const Order&) receives every
+    // message exactly once, in sequence order.
+    template <typename Emit>
+    void on_message(size_t line, uint64_t seq, const Order& o, Emit&& emit) {
+        stats_.received[line]++;
+        if (seq > last_[line]) {
+            stats_.line_gaps[line] += seq - last_[line] - 1;
+            last_[line] = seq;
+        }
+        if (seq < window_.next() || window_.holds(seq)) {
+            // A copy can still move last_ past a gap both lines lost and free what waits behind it.
+            stats_.duplicates++;
+            advance(emit);
+            return;
+        }
+        stats_.first[line]++;
+        if (seq == window_.next()) {
+            window_.pass(seq);
+            emit(o);
+            stats_.delivered++;
+        } else {
+            auto release = [&](const Order& m) { emit(m); stats_.delivered++; };
+            window_.make_room(seq, release, [&](uint64_t lost) { stats_.window_overflows++; gap(lost); });
+            window_.hold(seq, o);
+            stats_.max_pending = std::max(stats_.max_pending, window_.pending());
+        }
+        advance(emit);
+    }
+
+    uint64_t next_expected() const { return window_.next(); }
+    uint64_t pending() const { return window_.pending(); }
+    const ArbiterStats& stats() const { return stats_; }
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "order.hpp"
+#include "symbol_table.hpp"
+
+// Gateway reference data for the pre-trade check. Both structures are immutable once
+// published: an update copies, modifies and swaps the whole object (see EpochPtr), so
+// readers never see a half-applied change.
+
+struct Instrument {
+    uint32_t max_order_qty = 1000;
+    bool halted = false;
+};
+
+// Per-order limits that apply across instruments.
+struct RiskLimits {
+    uint64_t max_notional_cents = 15000000;   // $150k
+};
+
+enum class PreTradeResult : uint8_t { ACCEPT, UNKNOWN_SYMBOL, HALTED, QTY_LIMIT, NOTIONAL_LIMIT };
+constexpr size_t PRE_TRADE_RESULTS = 5;
+
+inline const char* pre_trade_result_name(PreTradeResult r) {
+    switch (r) {
+        case PreTradeResult::ACCEPT: return "accepted";
+        case PreTradeResult::UNKNOWN_SYMBOL: return "unknown symbol";
+        case PreTradeResult::HALTED: return "halted";
+        case PreTradeResult::QTY_LIMIT: return "over max qty";
+        case PreTradeResult::NOTIONAL_LIMIT: return "over max notional";
+    }
+    return "?";
+}
+
+// Tradable symbols and their per-instrument limits, indexed by SymbolTable id.
+class InstrumentRegistry {
+    SymbolTable symbols_;
+    std::vector<Instrument> instruments_;
+public:
+    explicit InstrumentRegistry(size_t max_symbols = 256) : symbols_(max_symbols) {}
+
+    // Adds sym (or returns it if listed); nullptr when the table is full.
+    Instrument* add(const char* sym) {
+        uint32_t id = symbols_.intern(sym);
+        if (id == SymbolTable::INVALID) return nullptr;
+        if (id >= instruments_.size()) instruments_.resize(id + 1);
+        return &instruments_[id];
+    }
+    Instrument* find(const char* sym) {
+        uint32_t id = symbols_.find(sym);
+        return id == SymbolTable::INVALID ? nullptr : &instruments_[id];
+    }
+    const Instrument* find(const char* sym) const {
+        uint32_t id = symbols_.find(sym);
+        return id == SymbolTable::INVALID ? nullptr : &instruments_[id];
+    }
+    size_t size() const { return instruments_.size(); }
+};
+
+inline PreTradeResult pre_trade_check(const Order& o, const InstrumentRegistry& reg, const RiskLimits& limits) {
+    const Instrument* ins = reg.find(o.symbol);
+    if (!ins) return PreTradeResult::UNKNOWN_SYMBOL;
+    if (ins->halted) return PreTradeResult::HALTED;
+    if (o.quantity > ins->max_order_qty) return PreTradeResult::QTY_LIMIT;
+    if (static_cast<uint64_t>(o.quantity) * o.price_cents > limits.max_notional_cents) return PreTradeResult::NOTIONAL_LIMIT;
+    return PreTradeResult::ACCEPT;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+// Log-linear latency histogram: every power of two is split into 16 linear
+// sub-buckets, so relative error stays under ~6% from 1ns up to the full uint64 range.
+// Not thread-safe; keep one per recording thread and merge() for reporting.
+class LatencyHistogram {
+    static constexpr int SUB_BITS = 4;
+    static constexpr uint64_t SUB_COUNT = 1u << SUB_BITS;
+    static constexpr size_t BUCKETS = 64 * SUB_COUNT;
+    std::array<uint64_t, BUCKETS> counts_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+
+    static size_t bucket_of(uint64_t v) {
+        if (v < SUB_COUNT) return static_cast<size_t>(v);
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BITS;
+        return static_cast<size_t>(shift + 1) * SUB_COUNT + ((v >> shift) & (SUB_COUNT - 1));
+    }
+    static uint64_t bucket_floor(size_t idx) {
+        if (idx < SUB_COUNT) return idx;
+        int shift = static_cast<int>(idx / SUB_COUNT) - 1;
+        return (SUB_COUNT + (idx % SUB_COUNT)) << shift;
+    }
+public:
+    void record(uint64_t ns) {
+        counts_[bucket_of(ns)]++;
+        count_++;
+        sum_ += ns;
+        min_ = std::min(min_, ns);
+        max_ = std::max(max_, ns);
+    }
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; ++i) counts_[i] += other.counts_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    // p in [0, 100]. Returns the lower edge of the bucket holding the p-th percentile.
+    uint64_t percentile(double p) const {
+        if (count_ == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(count_ - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::clamp(bucket_floor(i), min_, max_);
+        }
+        return max_;
+    }
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+    void reset() { *this = LatencyHistogram(); }
+};
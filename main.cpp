@@ -4,122 +4,399 @@
 #include <chrono>
 #include <random>
 #include <atomic>
+#include <mutex>
+#include <sstream>
+#include <algorithm>
 #include <signal.h>
 #include "ring_buffer.hpp"
 #include "batcher.hpp"
+#include "combining_batcher.hpp"
 #include <iomanip>
 #include "network_stats.hpp"
+#include "wire.hpp"
+#include "order_router.hpp"
+#include "redundant_sender.hpp"
+#include "rate_shaper.hpp"
+#include "fair_ingress.hpp"
+#include "reuseport_ingress.hpp"
+#include "async_logger.hpp"
+#include "pcap_capture.hpp"
+#include "epoch.hpp"
+#include "instrument_registry.hpp"
+#include "mpsc_queue.hpp"
+#include "latency_histogram.hpp"
+#include "src/network_sim/link_model.hpp"
+#include "src/network_loopback/loopback_common.hpp"
 
 // Network simulation headers
-void init_tcp_simulator(double, int, int, bool);
+void init_tcp_simulator(double, int, int, bool, const LinkConfig&);
 bool tcp_send_orders(const std::vector<Order>&, uint64_t);
-void init_udp_simulator(double, int, bool);
+void init_udp_simulator(double, int, bool, const LinkConfig&, const UDPPathConfig&);
 bool udp_send_orders(const std::vector<Order>&, uint64_t);
+void flush_udp_receiver();
 void init_shm_simulator(bool, int);
 bool shm_send_orders(const std::vector<Order>&, uint64_t);
 
-enum class NetworkType { TCP, UDP, SHM };
+// Real loopback transports to the venue emulator (run ./venue_emulator first)
+bool init_tcp_loopback(uint16_t, const LoopbackOptions&);
+bool tcp_loopback_send_orders(const std::vector<Order>&, uint64_t);
+bool init_udp_loopback(uint16_t, const LoopbackOptions&);
+bool udp_loopback_send_orders(const std::vector<Order>&, uint64_t);
+bool init_shm_loopback(const std::string&);
+bool shm_loopback_send_orders(const std::vector<Order>&, uint64_t);
+
+// Redundant A/B order feed into the ring buffer (replaces the producers)
+bool init_ab_feed(OrderRingBuffer&, std::function<Order()>, double, double, int);
+void stop_ab_feed();
+
+enum class NetworkType { TCP, UDP, SHM, LOOPBACK_TCP, LOOPBACK_UDP, LOOPBACK_SHM };
 struct Config {
     int producers = 2;
     int consumers = 2;
     size_t buffer_size = 1024;
     size_t batch_size = 10;
     int runtime_seconds = 30;
-    NetworkType net_type = NetworkType::TCP; // Change this to UDP or SHM as desired
+    NetworkType net_type = NetworkType::TCP; // Change this to UDP, SHM or a LOOPBACK_* venue transport
+    const char* log_path = "ring_buffer_demo.log"; // async diagnostics log (transport and feed messages)
+    // Wire capture: the LOOPBACK_TCP/LOOPBACK_UDP transports write every order frame sent
+    // and exec frame received to <capture_prefix>_tcp.pcap / _udp.pcap ("" = off).
+    std::string capture_prefix = "";
+    // LOOPBACK_TCP/LOOPBACK_UDP: kernel software timestamps (SO_TIMESTAMPING) split each
+    // round trip into app->kernel, kernel->kernel and kernel->app.
+    bool kernel_timestamps = true;
+    // Real-socket receivers (loopback readers, SO_REUSEPORT receivers): BLOCKING recv,
+    // BUSY_POLL (non-blocking spin with SO_BUSY_POLL) or ADAPTIVE (spin spin_us, then epoll).
+    RecvMode recv_mode = RecvMode::BLOCKING;
+    uint32_t spin_us = 200;
+    // Replay: instead of the producers, feed the order frames found in a capture back into
+    // the ring buffer, paced at replay_speed times the captured rate (0 = as fast as possible).
+    std::string replay_path = "";
+    double replay_speed = 1.0;
+    // Bottleneck link behind the simulated TCP and UDP transports: batches pay
+    // serialization by size and wait behind each other in a finite queue.
+    LinkConfig link;
+    // UDP simulator only: path reordering/duplication and the receiver's reorder buffer
+    UDPPathConfig udp_path;
+    // Smart order routing: when on, net_type is ignored and each order goes to one of
+    // route_venues (one batcher and transport each) as chosen by route_policy.
+    bool route_orders = false;
+    std::vector<NetworkType> route_venues = {NetworkType::TCP, NetworkType::UDP};
+    RoutePolicy route_policy = RoutePolicy::BLENDED;
+    // Redundant send: every batch goes over all redundant_paths at once and the first
+    // copy to arrive wins. Simulated transports only (the venue emulator does not dedup).
+    bool redundant_send = false;
+    std::vector<NetworkType> redundant_paths = {NetworkType::UDP, NetworkType::TCP};
+    // Egress shaping: batches leave each destination's batcher through a token-bucket
+    // shaper so the venue's message and byte rate limits are never exceeded.
+    bool shape_egress = true;
+    ShaperConfig shaper;
+    // Fair ingress: each producer is a client with its own queue, served into the ring by
+    // deficit round-robin (client_quantum orders per visit). Producer 0 additionally
+    // floods burst_orders back to back every burst_interval_ms (0 = never).
+    bool fair_ingress = false;
+    size_t client_queue_size = 1024;
+    uint32_t client_quantum = 4;
+    int burst_orders = 2000;
+    int burst_interval_ms = 0;
+    // SO_REUSEPORT ingress: each producer is a network client sending its orders over its
+    // own UDP socket; rx_threads pinned receivers share the port and each decodes into its
+    // own ring, drained by one consumer. Replaces fair_ingress when on.
+    bool reuseport_ingress = false;
+    int rx_threads = 2;
+    size_t rx_ring_size = 4096;
+    // A/B feed: orders arrive as one sequenced stream on two loopback UDP lines with
+    // independent loss, arbitrated into the ring buffer instead of by the producers.
+    bool ab_feed = false;
+    double feed_loss_a = 0.02;
+    double feed_loss_b = 0.02;
+    // Pre-trade check: consumers validate each order against the instrument registry and
+    // risk limits, read without locks under epoch-based reclamation. Every ops_interval_ms
+    // an ops thread publishes a change (GOOGL halted/resumed, notional limit tightened/
+    // relaxed) while the consumers keep reading (0 = never).
+    bool pretrade_check = false;
+    int ops_interval_ms = 250;
+    // Return path: pre-trade rejects (from the consumers) and the venue's exec reports
+    // (from the loopback readers) are queued back to the producer that sent the order,
+    // one MPSC queue per producer, with nodes from a pool of event_pool_size.
+    bool return_events = true;
+    size_t event_pool_size = 65536;
 };
 
 std::atomic<bool> running{true};
 std::unique_ptr<OrderRingBuffer> buffer;
-std::unique_ptr<Batcher> batcher;
+std::unique_ptr<CombiningBatcher> batcher;  // shared by the consumers
+std::unique_ptr<OrderRouter> router;
+std::unique_ptr<RedundantSender> redundant;
+std::unique_ptr<RateShaper> shaper;
+std::unique_ptr<FairIngress> ingress;
+std::vector<std::unique_ptr<AdaptiveRingBuffer>> rx_rings;
+std::unique_ptr<ReuseportIngress> rx_ingress;
+EpochManager epochs;
+std::unique_ptr<EpochPtr<InstrumentRegistry>> registry;
+std::unique_ptr<EpochPtr<RiskLimits>> risk_limits;
+std::atomic<uint64_t> pretrade_results[PRE_TRADE_RESULTS];
+std::atomic<uint64_t> ops_updates{0};
+// An exec report or gateway reject on its way back to the producer that sent the order.
+struct ClientEvent : MpscNode {
+    ExecReport report;
+    uint64_t queued_ns;
+};
+constexpr size_t EXEC_TYPES = 5;
+std::unique_ptr<NodePool<ClientEvent>> event_pool;
+std::vector<std::unique_ptr<MpscQueue<ClientEvent>>> client_events;  // by producer id
+std::atomic<uint64_t> events_dropped{0};
+std::mutex event_stats_mutex;
+uint64_t events_by_type[EXEC_TYPES] = {};
+LatencyHistogram event_delivery_ns;
 std::atomic<uint64_t> produced{0}, consumed{0};
-uint64_t batches_sent = 0;
-uint64_t total_batch_latency_us = 0;
+std::atomic<uint64_t> batches_sent{0};
+std::atomic<uint64_t> total_batch_latency_us{0};   // routed venues send from separate threads
 
 void signal_handler(int) { running = false; }
 
-void producer(int id) {
-    std::mt19937 gen(id);
+void print_loopback_stats(const char* name, const LoopbackStats& stats) {
+    std::cout << "\n=== Loopback " << name << " Statistics ===\n";
+    std::cout << "Batches sent: " << stats.batches_sent << "\n";
+    std::cout << "Batches acked: " << stats.batches_acked << "\n";
+    std::cout << "Send failures: " << stats.send_failures << "\n";
+    std::cout << "Acks/Fills/Cancels/Rejects: " << stats.acks << "/" << stats.fills << "/" << stats.cancels
+              << "/" << stats.rejects << "\n";
+    std::cout << "Stops triggered: " << stats.triggers << "\n";
+    std::cout << "Round trip: avg " << stats.avg_rtt_us << "\u03bcs, p50 " << stats.p50_rtt_ns / 1000.0
+              << "\u03bcs, p99 " << stats.p99_rtt_ns / 1000.0 << "\u03bcs, max " << stats.max_rtt_ns / 1000.0 << "\u03bcs\n";
+    const StackLatencyStats& k = stats.stack;
+    if (k.tx_stamps || k.rx_stamps) {
+        std::cout << "Stack (kernel timestamps, p50/p99): app->kernel " << k.p50_app_kernel_ns / 1000.0 << "/"
+                  << k.p99_app_kernel_ns / 1000.0 << "\u03bcs, kernel->kernel " << k.p50_kernel_kernel_ns / 1000.0 << "/"
+                  << k.p99_kernel_kernel_ns / 1000.0 << "\u03bcs, kernel->app " << k.p50_kernel_app_ns / 1000.0 << "/"
+                  << k.p99_kernel_app_ns / 1000.0 << "\u03bcs\n";
+        std::cout << "Kernel stamps: " << k.tx_stamps << " TX, " << k.rx_stamps << " RX, " << k.unmatched << " unmatched\n";
+    }
+    const RecvWaitStats& r = stats.recv;
+    std::cout << "Receive: " << r.mode << (r.kernel_busy_poll ? " (SO_BUSY_POLL)" : "") << ", reader CPU "
+              << r.cpu_pct << "%, " << r.empty_polls << " empty polls, " << r.parks << " parks\n";
+    if (stats.captured_frames || stats.capture_dropped)
+        std::cout << "Frames captured: " << stats.captured_frames << " (dropped " << stats.capture_dropped << ")\n";
+}
+
+// One synthetic order from producer id's flow.
+Order generate_order(std::mt19937& gen, uint64_t order_id, int id) {
+    static const std::vector<std::string> symbols = {"AAPL", "GOOGL", "MSFT"};
     std::uniform_real_distribution<> price(100, 200);
     std::uniform_int_distribution<> qty(1, 1000);
-    std::vector<std::string> symbols = {"AAPL", "GOOGL", "MSFT"};
+    std::uniform_int_distribution<> flow(0, 99);
+    OrderType side = (gen() & 1) ? OrderType::SELL : OrderType::BUY;
+    // IOC-heavy mix: 40% IOC, 10% FOK, 30% DAY, 20% GTC; 5% market, 5% stop, 5% stop-limit
+    int f = flow(gen);
+    TimeInForce tif = f < 40 ? TimeInForce::IOC : f < 50 ? TimeInForce::FOK : f < 80 ? TimeInForce::DAY : TimeInForce::GTC;
+    int k = flow(gen);
+    OrderKind kind = k < 5 ? OrderKind::MARKET : k < 10 ? OrderKind::STOP : k < 15 ? OrderKind::STOP_LIMIT : OrderKind::LIMIT;
+    Order o(order_id, symbols[gen() % symbols.size()], side, price(gen), qty(gen), tif, kind);
+    if (kind == OrderKind::STOP || kind == OrderKind::STOP_LIMIT) o.stop_price_cents = static_cast<uint32_t>(price(gen) * 100.0 + 0.5);
+    // One account and ingress client per producer; 20% carry self-trade prevention, 10% of resting flow is iceberg
+    o.account_id = static_cast<uint32_t>(id + 1);
+    o.client_id = static_cast<uint16_t>(id + 1);
+    int x = flow(gen);
+    if (x < 20) o.stp = static_cast<StpMode>(1 + x % 3);
+    if (flow(gen) < 10 && o.quantity > 10) o.display_qty = o.quantity / 10;
+    return o;
+}
+
+// Queues r for the producer whose order it answers (ids are producer * 1000000 + n).
+// Any thread; also the loopback transports' exec sink.
+void return_event(const ExecReport& r) {
+    size_t client = static_cast<size_t>(r.order_id / 1000000);
+    if (client >= client_events.size()) return;
+    ClientEvent* e = event_pool->acquire();
+    if (!e) {
+        events_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    e->report = r;
+    e->queued_ns = wire_now_ns();
+    client_events[client]->push(e);
+}
+
+void producer(int id, const Config& cfg) {
+    std::mt19937 gen(id);
     uint64_t order_id = id * 1000000;
+    MpscQueue<ClientEvent>* events = client_events.empty() ? nullptr : client_events[id].get();
+    uint64_t by_type[EXEC_TYPES] = {};
+    LatencyHistogram delivery_ns;
+    auto drain_events = [&] {
+        while (ClientEvent* e = events->pop()) {
+            by_type[std::min<size_t>(static_cast<size_t>(e->report.type), EXEC_TYPES - 1)]++;
+            delivery_ns.record(wire_now_ns() - e->queued_ns);
+            event_pool->release(e);
+        }
+    };
+    IngressSender sender;
+    if (rx_ingress && !sender.open(INGRESS_PORT)) {
+        LOG_ERROR("Producer {}: cannot open ingress socket", id);
+        return;
+    }
+    auto push = [&](const Order& o) {
+        bool ok = rx_ingress ? sender.send(o) : ingress ? ingress->try_push(o) : buffer->try_push(o);
+        if (ok) produced++;
+    };
+    auto next_burst = std::chrono::steady_clock::now() + std::chrono::milliseconds(cfg.burst_interval_ms);
     while (running) {
-        Order o(order_id++, symbols[gen() % symbols.size()], OrderType::BUY, price(gen), qty(gen));
-        if (buffer->try_push(o)) produced++;
+        push(generate_order(gen, order_id++, id));
+        if (id == 0 && cfg.burst_interval_ms > 0 && std::chrono::steady_clock::now() >= next_burst) {
+            for (int i = 0; i < cfg.burst_orders; ++i) push(generate_order(gen, order_id++, id));
+            next_burst += std::chrono::milliseconds(cfg.burst_interval_ms);
+        }
+        if (events) drain_events();
         std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
+    if (!events) return;
+    drain_events();
+    std::lock_guard<std::mutex> lock(event_stats_mutex);
+    for (size_t t = 0; t < EXEC_TYPES; ++t) events_by_type[t] += by_type[t];
+    event_delivery_ns.merge(delivery_ns);
 }
 
-void consumer() {
-    while (running) {
-        Order o;
-        if (buffer->try_pop(o)) {
-            batcher->add_order(o);
-            consumed++;
+// Moves orders from the per-client queues into the ring buffer.
+void ingress_scheduler() {
+    while (running)
+        if (!ingress->service()) std::this_thread::yield();
+}
+
+// Feeds the order frames of a capture into the ring buffer in place of the producers.
+// Orders are restamped on entry so queueing latency is measured from the replay.
+uint64_t replay_frames = 0;
+void replayer(const Config& cfg) {
+    PcapReader reader;
+    if (!reader.open(cfg.replay_path)) {
+        LOG_ERROR("Replay: cannot read capture {}", cfg.replay_path);
+        return;
+    }
+    PcapFrame f;
+    WireHeader hdr;
+    std::vector<Order> orders;
+    uint64_t first_ts = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (running && reader.next(f)) {
+        if (f.dst_port != VENUE_TCP_PORT && f.dst_port != VENUE_UDP_PORT) continue;
+        if (!decode_frame(f.payload.data(), f.payload.size(), MsgType::ORDER_BATCH, hdr, orders)) continue;
+        if (!first_ts) first_ts = f.ts_ns;
+        if (cfg.replay_speed > 0)
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(static_cast<uint64_t>((f.ts_ns - first_ts) / cfg.replay_speed)));
+        replay_frames++;
+        for (Order& o : orders) {
+            o.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+            bool pushed = false;
+            while (running && !(pushed = buffer->try_push(o))) std::this_thread::yield();
+            if (pushed) produced++;
         }
-        std::this_thread::sleep_for(std::chrono::microseconds(10));
     }
+    LOG_INFO("Replay: {} order frames from {}", replay_frames, cfg.replay_path);
 }
 
-int main() {
-    signal(SIGINT, signal_handler);
-    Config cfg;
-    buffer = std::make_unique<OrderRingBuffer>(cfg.buffer_size);
+// Per-destination counters when routing; send latency covers the transport call.
+struct VenueStats {
+    std::atomic<uint64_t> orders{0}, batches{0}, failures{0};
+    std::mutex mutex;
+    LatencyHistogram send_ns;
+    LatencyHistogram route_ns; // sampled decision time
+};
+std::vector<std::unique_ptr<CombiningBatcher>> venue_batchers;
+std::vector<std::unique_ptr<VenueStats>> venue_stats;
+std::vector<std::unique_ptr<RateShaper>> venue_shapers;
 
-    // Initialize network simulation
-    switch (cfg.net_type) {
-        case NetworkType::TCP:
-            init_tcp_simulator(0.02, 5, 3, true);
-            break;
-        case NetworkType::UDP:
-            init_udp_simulator(0.02, 1000, true);
-            break;
-        case NetworkType::SHM:
-            init_shm_simulator(true, 100);
-            break;
+const char* network_name(NetworkType t) {
+    switch (t) {
+        case NetworkType::TCP: return "TCP";
+        case NetworkType::UDP: return "UDP";
+        case NetworkType::SHM: return "SHM";
+        case NetworkType::LOOPBACK_TCP: return "LOOPBACK_TCP";
+        case NetworkType::LOOPBACK_UDP: return "LOOPBACK_UDP";
+        case NetworkType::LOOPBACK_SHM: return "LOOPBACK_SHM";
     }
+    return "?";
+}
 
-    // Batcher sends batches through the selected network simulation
-    batcher = std::make_unique<Batcher>(cfg.batch_size, std::chrono::microseconds(1000),
-        [&cfg](const std::vector<Order>& batch, uint64_t latency_us) {
-            switch (cfg.net_type) {
-                case NetworkType::TCP:
-                    tcp_send_orders(batch, latency_us);
-                    break;
-                case NetworkType::UDP:
-                    udp_send_orders(batch, latency_us);
-                    break;
-                case NetworkType::SHM:
-                    shm_send_orders(batch, latency_us);
-                    break;
-            }
-            batches_sent++;
-            total_batch_latency_us += latency_us;
-        });
+// Starting point for the router's tables: fee, one-way latency and fill odds by transport.
+VenueProfile venue_profile(NetworkType t) {
+    VenueProfile p;
+    p.name = network_name(t);
+    switch (t) {
+        case NetworkType::TCP: p.fee_mils_per_share = 300; p.latency_ns = 5000000; p.fill_prob = VenueProfile::fill_table(64000, 500); break;
+        case NetworkType::UDP: p.fee_mils_per_share = 100; p.latency_ns = 1000000; p.fill_prob = VenueProfile::fill_table(60000, 4000); break;
+        case NetworkType::SHM: p.fee_mils_per_share = 200; p.latency_ns = 1000; p.fill_prob = VenueProfile::fill_table(65000, 1000); break;
+        default: p.fee_mils_per_share = 250; p.latency_ns = 50000; p.fill_prob = VenueProfile::fill_table(62000, 1500); break;
+    }
+    return p;
+}
 
-    std::vector<std::thread> threads;
-    for (int i = 0; i < cfg.producers; ++i) threads.emplace_back(producer, i);
-    for (int i = 0; i < cfg.consumers; ++i) threads.emplace_back(consumer);
-    std::cout << "System running for " << cfg.runtime_seconds << " seconds...\n";
-    std::this_thread::sleep_for(std::chrono::seconds(cfg.runtime_seconds));
-    running = false;
-    for (auto& t : threads) t.join();
+LoopbackOptions loopback_options(const Config& cfg, const char* transport) {
+    LoopbackOptions o;
+    if (!cfg.capture_prefix.empty()) o.capture_path = cfg.capture_prefix + "_" + transport + ".pcap";
+    o.kernel_timestamps = cfg.kernel_timestamps;
+    o.recv_mode = cfg.recv_mode;
+    o.spin_us = cfg.spin_us;
+    return o;
+}
 
-    std::cout << "\n=== Final Statistics ===\n";
-    std::cout << "Total orders produced: " << produced << "\n";
-    std::cout << "Total orders consumed: " << consumed << "\n";
-    std::cout << "Total batches sent: " << batches_sent << "\n";
-    double avg_batch_latency = batches_sent ? (double)total_batch_latency_us / batches_sent : 0.0;
-    std::cout << "Average batch latency: " << std::fixed << std::setprecision(2) << avg_batch_latency << "\u03bcs\n";
+bool init_network(NetworkType t, const Config& cfg) {
+    switch (t) {
+        case NetworkType::TCP: init_tcp_simulator(0.02, 5, 3, true, cfg.link); return true;
+        case NetworkType::UDP: init_udp_simulator(0.02, 1000, true, cfg.link, cfg.udp_path); return true;
+        case NetworkType::SHM: init_shm_simulator(true, 100); return true;
+        case NetworkType::LOOPBACK_TCP: return init_tcp_loopback(VENUE_TCP_PORT, loopback_options(cfg, "tcp"));
+        case NetworkType::LOOPBACK_UDP: return init_udp_loopback(VENUE_UDP_PORT, loopback_options(cfg, "udp"));
+        case NetworkType::LOOPBACK_SHM: return init_shm_loopback(VENUE_SHM_NAME);
+    }
+    return false;
+}
 
-    switch (cfg.net_type) {
+bool send_orders(NetworkType t, const std::vector<Order>& batch, uint64_t latency_us) {
+    switch (t) {
+        case NetworkType::TCP: return tcp_send_orders(batch, latency_us);
+        case NetworkType::UDP: return udp_send_orders(batch, latency_us);
+        case NetworkType::SHM: return shm_send_orders(batch, latency_us);
+        case NetworkType::LOOPBACK_TCP: return tcp_loopback_send_orders(batch, latency_us);
+        case NetworkType::LOOPBACK_UDP: return udp_loopback_send_orders(batch, latency_us);
+        case NetworkType::LOOPBACK_SHM: return shm_loopback_send_orders(batch, latency_us);
+    }
+    return false;
+}
+
+void print_link_stats(const LinkStats& l) {
+    uint64_t sent = l.batches - l.tail_drops - l.red_drops;
+    std::cout << "Link: " << std::fixed << std::setprecision(0) << l.bandwidth_mbps << " Mbps, MTU " << l.mtu_bytes
+              << ", " << l.packets << " packets for " << sent << " batches\n";
+    std::cout << "Wire efficiency: " << std::setprecision(1)
+              << (l.wire_bytes ? 100.0 * l.payload_bytes / l.wire_bytes : 0.0) << "% (" << l.payload_bytes << " of "
+              << l.wire_bytes << " bytes)\n";
+    std::cout << "Serialization: avg " << (sent ? l.serialization_ns / 1000.0 / sent : 0.0) << "\u03bcs, queueing: avg "
+              << (sent ? l.queueing_ns / 1000.0 / sent : 0.0) << "\u03bcs, max queue " << l.max_queue_bytes << " bytes\n";
+    std::cout << "Queue drops: " << l.tail_drops << " tail, " << l.red_drops << " early (RED)\n";
+}
+
+void print_reorder_stats(const ReorderStats& r) {
+    std::cout << "Path: " << r.reordered << " reordered, " << r.duplicated << " duplicated\n";
+    std::cout << "Reorder buffer (" << r.window << " slots, " << r.max_hold_us << "\u03bcs max hold): " << r.delivered
+              << " delivered in sequence, " << r.held << " held, max " << r.max_pending << " pending, max "
+              << r.max_displacement << " ahead\n";
+    std::cout << "Discarded: " << r.duplicates << " duplicates, " << r.late << " late; gaps given up: "
+              << r.hold_timeouts << " on hold timeout, " << r.window_overflows << " on overflow (" << r.lost << " lost)\n";
+    std::cout << "Hold time: p50 " << r.p50_hold_ns / 1000.0 << "\u03bcs, p99 " << r.p99_hold_ns / 1000.0 << "\u03bcs, max "
+              << r.max_hold_ns / 1000.0 << "\u03bcs; delivery p50 " << r.p50_delivery_ns / 1000.0 << "\u03bcs, p99 "
+              << r.p99_delivery_ns / 1000.0 << "\u03bcs\n";
+}
+
+void print_network_stats(NetworkType t) {
+    switch (t) {
         case NetworkType::TCP: {
             auto stats = get_tcp_stats();
             std::cout << "\n=== TCP Network Statistics ===\n";
             std::cout << "Dropped packets: " << stats.dropped_packets << "\n";
             std::cout << "Retransmissions: " << stats.retransmissions << "\n";
             std::cout << "Base delay: " << stats.base_delay_ms << "ms\n";
-            std::cout << "Drop rate: " << stats.drop_rate << "\n";
+            std::cout << "Drop rate: " << stats.drop_rate << " per segment\n";
+            print_link_stats(stats.link);
             break;
         }
         case NetworkType::UDP: {
@@ -128,7 +405,9 @@ int main() {
             std::cout << "Packets sent: " << stats.packets_sent << "\n";
             std::cout << "Packets dropped: " << stats.packets_dropped << "\n";
             std::cout << "Base delay: " << stats.base_delay_us << "\u03bcs\n";
-            std::cout << "Drop rate: " << stats.drop_rate << "\n";
+            std::cout << "Drop rate: " << stats.drop_rate << " per fragment\n";
+            print_link_stats(stats.link);
+            print_reorder_stats(stats.reorder);
             break;
         }
         case NetworkType::SHM: {
@@ -138,7 +417,372 @@ int main() {
             std::cout << "Noise range: " << stats.noise_range_ns << "ns\n";
             break;
         }
+        case NetworkType::LOOPBACK_TCP:
+            print_loopback_stats("TCP", get_tcp_loopback_stats());
+            break;
+        case NetworkType::LOOPBACK_UDP:
+            print_loopback_stats("UDP", get_udp_loopback_stats());
+            break;
+        case NetworkType::LOOPBACK_SHM:
+            print_loopback_stats("SHM", get_shm_loopback_stats());
+            break;
+    }
+}
+
+void print_routing_stats(const Config& cfg) {
+    static const char* policy_names[] = {"cost", "latency", "fill probability", "blended"};
+    std::cout << "\n=== Routing Statistics (" << policy_names[static_cast<int>(cfg.route_policy)] << ") ===\n";
+    LatencyHistogram decisions;
+    for (size_t v = 0; v < venue_stats.size(); ++v) {
+        VenueStats& s = *venue_stats[v];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        decisions.merge(s.route_ns);
+        uint64_t sent = s.batches.load();
+        std::cout << "Venue " << router->name(static_cast<uint32_t>(v)) << ": " << s.orders << " orders in " << sent
+                  << " batches, delivered " << std::fixed << std::setprecision(1)
+                  << (sent ? 100.0 * (sent - s.failures) / sent : 0.0) << "%, send p50 "
+                  << s.send_ns.percentile(50) / 1000.0 << "\u03bcs, p99 " << s.send_ns.percentile(99) / 1000.0
+                  << "\u03bcs, latency estimate " << router->latency_estimate(static_cast<uint32_t>(v)) / 1000.0 << "\u03bcs\n";
+    }
+    std::cout << "Routing decision (sampled): p50 " << decisions.percentile(50) << "ns, p99 " << decisions.percentile(99)
+              << "ns, max " << decisions.max() << "ns\n";
+}
+
+void print_feed_stats(const FeedStats& s) {
+    std::cout << "\n=== A/B Feed Statistics ===\n";
+    std::cout << "Published: " << s.published << ", delivered in sequence: " << s.delivered << "\n";
+    std::cout << "Line A: received " << s.received_a << ", first " << s.first_a << ", missed " << s.gaps_a << "\n";
+    std::cout << "Line B: received " << s.received_b << ", first " << s.first_b << ", missed " << s.gaps_b << "\n";
+    std::cout << "Gaps filled from the other line: " << s.recovered << "\n";
+    std::cout << "Unrecoverable: " << s.lost << " messages in " << s.unrecoverable_gaps << " gaps\n";
+    std::cout << "Duplicates discarded: " << s.duplicates << "\n";
+    std::cout << "Ring full waits: " << s.ring_full_waits << "\n";
+    std::cout << "Arbitration (sampled): p50 " << s.p50_arb_ns << "ns, p99 " << s.p99_arb_ns << "ns\n";
+    std::cout << "Publish to ring: p50 " << s.p50_feed_ns / 1000.0 << "\u03bcs, p99 " << s.p99_feed_ns / 1000.0 << "\u03bcs\n";
+}
+
+void print_redundancy_stats(const RedundancyStats& s) {
+    auto pct = [](const LatencyHistogram& h) {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(1) << "p50 " << h.percentile(50) / 1000.0 << "\u03bcs, p99 "
+           << h.percentile(99) / 1000.0 << "\u03bcs, p99.9 " << h.percentile(99.9) / 1000.0 << "\u03bcs";
+        return os.str();
+    };
+    // Tail of a path on its own: a lost copy never arrives, so it ranks above every delivered one.
+    auto with_losses = [](const PathStats& p, double q) {
+        std::ostringstream os;
+        uint64_t total = p.delivered + p.lost;
+        double rank = q / 100.0 * total;
+        if (!total || rank > p.delivered) os << "lost";
+        else os << std::fixed << std::setprecision(1) << p.latency_ns.percentile(100.0 * rank / p.delivered) / 1000.0 << "\u03bcs";
+        return os.str();
+    };
+    std::cout << "\n=== Redundant Send Statistics ===\n";
+    for (const PathStats& p : s.paths) {
+        std::cout << "Path " << p.name << ": sent " << p.sent << ", lost " << p.lost << ", first " << p.won
+                  << ", suppressed before send " << p.suppressed << ", " << pct(p.latency_ns) << "\n";
+        std::cout << "  alone, counting losses: p99 " << with_losses(p, 99) << ", p99.9 " << with_losses(p, 99.9) << "\n";
+    }
+    std::cout << "First arrival: " << s.unique << "/" << s.batches << " batches, " << pct(s.first_ns) << "\n";
+    std::cout << "Duplicates discarded: " << s.duplicates << "\n";
+    std::cout << "Bandwidth: " << s.bytes_sent << " bytes sent for " << s.bytes_unique << " unique ("
+              << std::fixed << std::setprecision(1)
+              << (s.bytes_unique ? 100.0 * (s.bytes_sent - s.bytes_unique) / s.bytes_unique : 0.0) << "% overhead)\n";
+}
+
+void print_shaper_stats(const std::string& title, const ShaperConfig& cfg, const ShaperStats& s) {
+    std::cout << "\n=== " << title << " ===\n";
+    std::cout << "Limits: " << std::fixed << std::setprecision(0) << cfg.msgs_per_sec << " msgs/s (burst " << cfg.burst_msgs
+              << "), " << cfg.bytes_per_sec << " bytes/s (burst " << cfg.burst_bytes << ")\n";
+    std::cout << "Batches: " << s.submitted << " submitted, " << s.held << " held, " << s.merged << " merged, "
+              << s.queued << " still queued (max " << s.max_queue << ")\n";
+    std::cout << "Sent: " << s.sent_msgs << " messages, " << s.sent_orders << " orders, " << s.sent_bytes << " bytes\n";
+    std::cout << "Shaping delay: p50 " << std::setprecision(1) << s.delay_ns.percentile(50) / 1000.0 << "\u03bcs, p99 "
+              << s.delay_ns.percentile(99) / 1000.0 << "\u03bcs, max " << s.delay_ns.max() / 1000.0 << "\u03bcs\n";
+}
+
+void print_ingress_stats(const FairIngress& in) {
+    std::cout << "\n=== Fair Ingress Statistics ===\n";
+    uint64_t total = 0;
+    for (uint16_t c = 1; c <= in.clients(); ++c) total += in.stats(c).forwarded;
+    for (uint16_t c = 1; c <= in.clients(); ++c) {
+        ClientIngressStats s = in.stats(c);
+        std::cout << "Client " << c << " (quantum " << s.quantum << "): " << s.submitted << " submitted, " << s.rejected
+                  << " rejected, " << s.forwarded << " forwarded (" << std::fixed << std::setprecision(1)
+                  << (total ? 100.0 * s.forwarded / total : 0.0) << "% share), wait p50 " << s.wait_ns.percentile(50) / 1000.0
+                  << "\u03bcs, p99 " << s.wait_ns.percentile(99) / 1000.0 << "\u03bcs, max " << s.wait_ns.max() / 1000.0 << "\u03bcs\n";
+    }
+    if (in.untagged()) std::cout << "Rejected without a known client: " << in.untagged() << "\n";
+}
+
+void print_rx_ingress_stats(const ReuseportIngressStats& s) {
+    std::cout << "\n=== SO_REUSEPORT Ingress Statistics ===\n";
+    uint64_t reordered = 0;
+    for (size_t r = 0; r < s.receivers.size(); ++r) {
+        const ReceiverStats& rs = s.receivers[r];
+        reordered += rs.reordered;
+        std::cout << "Receiver " << r << " (cpu " << rs.cpu << "): " << rs.datagrams << " orders from " << rs.clients
+                  << " clients, " << rs.gaps << " lost, " << rs.reordered << " reordered, " << rs.bad << " bad, "
+                  << rs.ring_full_waits << " ring-full waits; " << rs.recv.mode << ", CPU " << rs.recv.cpu_pct << "%\n";
+    }
+    std::cout << "Per-client ordering: " << (s.split_clients == 0 && reordered == 0 ? "held" : "BROKEN") << " ("
+              << s.split_clients << " clients split across receivers)\n";
+    std::cout << "Ingress latency: p50 " << s.p50_ingress_ns / 1000.0 << "\u03bcs, p99 " << s.p99_ingress_ns / 1000.0 << "\u03bcs\n";
+}
+
+void consumer(int id, const Config& cfg) {
+    // The shared ring, or this consumer's share of the receiver rings (one consumer each)
+    OrderRingBuffer* shared = rx_rings.empty() ? buffer.get() : nullptr;
+    std::vector<AdaptiveRingBuffer*> rx;
+    for (size_t r = static_cast<size_t>(id); r < rx_rings.size(); r += static_cast<size_t>(cfg.consumers))
+        rx.push_back(rx_rings[r].get());
+    EpochManager::Participant epoch(epochs);
+    uint64_t results[PRE_TRADE_RESULTS] = {};
+    uint64_t n = 0;
+    const InstrumentRegistry* reg = nullptr;
+    const RiskLimits* limits = nullptr;
+    auto handle = [&](const Order& o) {
+        if (reg) {
+            PreTradeResult r = pre_trade_check(o, *reg, *limits);
+            results[static_cast<size_t>(r)]++;
+            if (r != PreTradeResult::ACCEPT) {
+                return_event(ExecReport{o.order_id, 0, 0, 0, ExecType::REJECT});
+                consumed++;
+                return;
+            }
+        }
+        if (router) {
+            // Time one decision in 64; the clock reads cost as much as the decision itself.
+            bool sample = (n++ & 63) == 0;
+            auto start = sample ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+            uint32_t v = router->route(o);
+            if (sample) {
+                uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                std::lock_guard<std::mutex> lock(venue_stats[v]->mutex);
+                venue_stats[v]->route_ns.record(ns);
+            }
+            venue_stats[v]->orders++;
+            venue_batchers[v]->add_order(o);
+        } else {
+            batcher->add_order(o);
+        }
+        consumed++;
+    };
+    while (running) {
+        // Reference data for this iteration; the pointers are good until the next announce()
+        epoch.announce();
+        reg = registry ? registry->load() : nullptr;
+        limits = risk_limits ? risk_limits->load() : nullptr;
+        Order o;
+        if (shared && shared->try_pop(o)) handle(o);
+        for (AdaptiveRingBuffer* ring : rx)
+            if (ring->try_pop(o)) handle(o);
+        if (shaper) shaper->poll();
+        for (auto& s : venue_shapers) s->poll();
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+    for (size_t r = 0; r < PRE_TRADE_RESULTS; ++r) pretrade_results[r] += results[r];
+}
+
+// Intraday reference data changes, published while the consumers are reading.
+void ops_updater(const Config& cfg) {
+    bool tight = false;
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(cfg.ops_interval_ms));
+        tight = !tight;
+        registry->update([tight](InstrumentRegistry& r) { r.find("GOOGL")->halted = tight; });
+        risk_limits->update([tight](RiskLimits& l) { l.max_notional_cents = tight ? 10000000 : 15000000; });
+        ops_updates += 2;
+    }
+}
+
+void print_event_stats() {
+    static const char* names[EXEC_TYPES] = {"acks", "fills", "rejects", "cancels", "triggers"};
+    std::lock_guard<std::mutex> lock(event_stats_mutex);
+    std::cout << "\n=== Client Event Statistics ===\n";
+    uint64_t total = 0;
+    for (uint64_t n : events_by_type) total += n;
+    std::cout << "Events returned: " << total << " (";
+    for (size_t t = 0; t < EXEC_TYPES; ++t) std::cout << (t ? ", " : "") << names[t] << " " << events_by_type[t];
+    std::cout << "), dropped " << events_dropped << " (pool empty)\n";
+    std::cout << "Queue to producer: p50 " << event_delivery_ns.percentile(50) / 1000.0 << "\u03bcs, p99 "
+              << event_delivery_ns.percentile(99) / 1000.0 << "\u03bcs\n";
+}
+
+void print_pretrade_stats() {
+    std::cout << "\n=== Pre-Trade Check Statistics ===\n";
+    for (size_t r = 0; r < PRE_TRADE_RESULTS; ++r)
+        std::cout << pre_trade_result_name(static_cast<PreTradeResult>(r)) << ": " << pretrade_results[r] << "\n";
+    std::cout << "Reference data updates: " << ops_updates << " (epoch " << epochs.epoch() << ", "
+              << epochs.retired() << " versions retired, " << epochs.freed() << " freed)\n";
+}
+
+int main() {
+    signal(SIGINT, signal_handler);
+    Config cfg;
+    AsyncLogger::instance().start(cfg.log_path);
+    buffer = std::make_unique<OrderRingBuffer>(cfg.buffer_size);
+
+    bool producers_run = !cfg.ab_feed && cfg.replay_path.empty();
+    if (cfg.return_events && producers_run) {
+        event_pool = std::make_unique<NodePool<ClientEvent>>(cfg.event_pool_size);
+        for (int i = 0; i < cfg.producers; ++i) client_events.push_back(std::make_unique<MpscQueue<ClientEvent>>());
+        exec_sink().store(return_event);
+    }
+
+    // Initialize network simulation: the one selected transport, or every routed venue
+    std::vector<NetworkType> networks = cfg.route_orders ? cfg.route_venues
+                                      : cfg.redundant_send ? cfg.redundant_paths
+                                      : std::vector<NetworkType>{cfg.net_type};
+    bool net_ok = true;
+    if (cfg.redundant_send)
+        for (NetworkType t : networks)
+            if (t != NetworkType::TCP && t != NetworkType::UDP && t != NetworkType::SHM) {
+                std::cerr << "Redundant send supports simulated transports only\n";
+                return 1;
+            }
+    for (NetworkType t : networks) net_ok = init_network(t, cfg) && net_ok;
+    if (!net_ok) {
+        std::cerr << "Network initialization failed (see " << cfg.log_path << "); is venue_emulator running?\n";
+        return 1;
+    }
+
+    if (cfg.route_orders) {
+        std::vector<VenueProfile> profiles;
+        for (NetworkType t : networks) profiles.push_back(venue_profile(t));
+        router = std::make_unique<OrderRouter>(profiles, cfg.route_policy);
+        for (size_t v = 0; v < networks.size(); ++v) {
+            venue_stats.push_back(std::make_unique<VenueStats>());
+            NetworkType t = networks[v];
+            Batcher::SendFn send = [t, v](const std::vector<Order>& batch, uint64_t latency_us) {
+                    auto start = std::chrono::steady_clock::now();
+                    bool ok = send_orders(t, batch, latency_us);
+                    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                    VenueStats& s = *venue_stats[v];
+                    s.batches++;
+                    if (!ok) s.failures++;
+                    {
+                        std::lock_guard<std::mutex> lock(s.mutex);
+                        s.send_ns.record(ns);
+                    }
+                    router->observe_latency(static_cast<uint32_t>(v), ns);
+                    batches_sent++;
+                    total_batch_latency_us += latency_us;
+                };
+            if (cfg.shape_egress) {
+                venue_shapers.push_back(std::make_unique<RateShaper>(cfg.shaper, send));
+                RateShaper* s = venue_shapers.back().get();
+                send = [s](const std::vector<Order>& batch, uint64_t latency_us) { s->submit(batch, latency_us); };
+            }
+            venue_batchers.push_back(std::make_unique<CombiningBatcher>(cfg.batch_size, std::chrono::microseconds(1000), send));
+        }
+    }
+
+    if (cfg.redundant_send) {
+        std::vector<std::pair<std::string, RedundantSender::SendFn>> paths;
+        for (NetworkType t : networks)
+            paths.emplace_back(network_name(t), [t](const std::vector<Order>& batch, uint64_t latency_us) {
+                return send_orders(t, batch, latency_us);
+            });
+        redundant = std::make_unique<RedundantSender>(paths);
+    }
+
+    // Batcher sends batches through the selected network simulation (or all redundant paths),
+    // by way of the egress shaper when one is configured
+    Batcher::SendFn send = [&cfg](const std::vector<Order>& batch, uint64_t latency_us) {
+        if (redundant) redundant->send(batch, latency_us);
+        else send_orders(cfg.net_type, batch, latency_us);
+        batches_sent++;
+        total_batch_latency_us += latency_us;
+    };
+    if (cfg.shape_egress && !cfg.route_orders) {
+        shaper = std::make_unique<RateShaper>(cfg.shaper, send);
+        send = [](const std::vector<Order>& batch, uint64_t latency_us) { shaper->submit(batch, latency_us); };
+    }
+    batcher = std::make_unique<CombiningBatcher>(cfg.batch_size, std::chrono::microseconds(1000), send);
+
+    std::vector<std::thread> threads;
+    if (cfg.pretrade_check) {
+        auto reg = std::make_unique<InstrumentRegistry>();
+        for (const char* sym : {"AAPL", "GOOGL", "MSFT"}) reg->add(sym);
+        registry = std::make_unique<EpochPtr<InstrumentRegistry>>(epochs, std::move(reg));
+        risk_limits = std::make_unique<EpochPtr<RiskLimits>>(epochs, std::make_unique<RiskLimits>());
+        if (cfg.ops_interval_ms > 0) threads.emplace_back(ops_updater, std::cref(cfg));
+    }
+    if (cfg.ab_feed) {
+        auto gen = std::make_shared<std::mt19937>(0);
+        auto order_id = std::make_shared<uint64_t>(0);
+        if (!init_ab_feed(*buffer, [gen, order_id] { return generate_order(*gen, (*order_id)++, 0); },
+                          cfg.feed_loss_a, cfg.feed_loss_b, 100)) return 1;
+    } else if (!cfg.replay_path.empty()) {
+        threads.emplace_back(replayer, std::cref(cfg));
+    } else {
+        if (cfg.reuseport_ingress) {
+            std::vector<AdaptiveRingBuffer*> rings;
+            for (int r = 0; r < cfg.rx_threads; ++r) {
+                rx_rings.push_back(std::make_unique<AdaptiveRingBuffer>(cfg.rx_ring_size));
+                rings.push_back(rx_rings.back().get());
+            }
+            rx_ingress = std::make_unique<ReuseportIngress>(INGRESS_PORT, rings, static_cast<size_t>(cfg.producers));
+            if (!rx_ingress->start(0, cfg.recv_mode, cfg.spin_us)) {
+                std::cerr << "Cannot bind SO_REUSEPORT ingress port " << INGRESS_PORT << "\n";
+                return 1;
+            }
+        } else if (cfg.fair_ingress) {
+            ingress = std::make_unique<FairIngress>(*buffer, cfg.producers, cfg.client_queue_size, cfg.client_quantum);
+            threads.emplace_back(ingress_scheduler);
+        }
+        for (int i = 0; i < cfg.producers; ++i) threads.emplace_back(producer, i, std::cref(cfg));
+    }
+    for (int i = 0; i < cfg.consumers; ++i) threads.emplace_back(consumer, i, std::cref(cfg));
+    std::cout << "System running for " << cfg.runtime_seconds << " seconds...\n";
+    std::this_thread::sleep_for(std::chrono::seconds(cfg.runtime_seconds));
+    running = false;
+    if (cfg.ab_feed) stop_ab_feed();
+    for (auto& t : threads) t.join();
+    if (rx_ingress) rx_ingress->stop();
+    // The consumers no longer poll the shapers; send what they still hold
+    if (shaper) shaper->drain();
+    for (auto& s : venue_shapers) s->drain();
+    // Nothing is sent any more; count what the UDP receiver still holds back
+    for (NetworkType t : networks)
+        if (t == NetworkType::UDP) flush_udp_receiver();
+
+    std::cout << "\n=== Final Statistics ===\n";
+    if (cfg.ab_feed) produced = get_ab_feed_stats().published;
+    std::cout << "Total orders produced: " << produced << "\n";
+    if (!cfg.replay_path.empty()) std::cout << "Replayed order frames: " << replay_frames << "\n";
+    std::cout << "Total orders consumed: " << consumed << "\n";
+    std::cout << "Total batches sent: " << batches_sent << "\n";
+    double avg_batch_latency = batches_sent ? (double)total_batch_latency_us / batches_sent : 0.0;
+    std::cout << "Average batch latency: " << std::fixed << std::setprecision(2) << avg_batch_latency << "\u03bcs\n";
+    CombiningStats cs = batcher->stats();
+    for (auto& b : venue_batchers) {
+        CombiningStats v = b->stats();
+        cs.passes += v.passes;
+        cs.orders += v.orders;
+        cs.max_per_pass = std::max(cs.max_per_pass, v.max_per_pass);
+    }
+    if (cs.passes)
+        std::cout << "Batcher combining: " << cs.orders << " orders in " << cs.passes << " passes ("
+                  << static_cast<double>(cs.orders) / cs.passes << " avg, " << cs.max_per_pass << " max per pass)\n";
+
+    if (cfg.ab_feed) print_feed_stats(get_ab_feed_stats());
+    if (registry) print_pretrade_stats();
+    exec_sink().store(nullptr);
+    if (event_pool) print_event_stats();
+    if (ingress) print_ingress_stats(*ingress);
+    if (rx_ingress) print_rx_ingress_stats(rx_ingress->stats());
+    if (cfg.route_orders) print_routing_stats(cfg);
+    if (shaper) print_shaper_stats("Egress Shaping Statistics", cfg.shaper, shaper->stats());
+    for (size_t v = 0; v < venue_shapers.size(); ++v)
+        print_shaper_stats("Egress Shaping Statistics (" + router->name(static_cast<uint32_t>(v)) + ")", cfg.shaper,
+                           venue_shapers[v]->stats());
+    if (redundant) {
+        redundant->stop();
+        print_redundancy_stats(redundant->stats());
     }
+    for (NetworkType t : networks) print_network_stats(t);
     std::cout << "==============================\n";
     return 0;
 }
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "order.hpp"
+#include "order_book.hpp"
+#include "stop_triggers.hpp"
+#include "ring_buffer.hpp"
+#include "symbol_table.hpp"
+#include "latency_histogram.hpp"
+#include "position_keeper.hpp"
+#include "wire.hpp"
+
+struct EngineStats {
+    uint64_t orders = 0;
+    uint64_t fills = 0;
+    uint64_t rejects = 0;
+    uint64_t filled_qty = 0;
+    uint64_t cancelled = 0;
+    uint64_t expired = 0;
+    uint64_t stops_armed = 0;
+    uint64_t stops_triggered = 0;
+    uint64_t self_trades_prevented = 0;
+    uint64_t risk_rejects = 0; // orders over the account's gross exposure limit
+    uint64_t max_cascade = 0; // stops activated by a single inbound order
+    LatencyHistogram trigger_ns; // time to fire the crossed buckets of one trade run
+    uint64_t auctions = 0;
+    uint64_t auction_volume = 0;
+    LatencyHistogram uncross_ns;
+    std::array<uint64_t, TIF_COUNT> orders_by_tif{};
+    std::array<LatencyHistogram, TIF_COUNT> match_ns_by_tif; // indexed by TimeInForce
+};
+
+// One execution on the public tape (self-trade restatements are not trades).
+struct TradePrint {
+    uint64_t ts_ns; // steady clock, same base as wire_now_ns()
+    uint32_t symbol_id;
+    uint32_t price_cents;
+    uint32_t qty;
+};
+
+// Venue-side matching: one OrderBook and StopTriggerBook per interned symbol.
+// Each inbound batch becomes ACK/REJECT, taker and maker FILL, TRIGGERED for
+// activated stops and CANCEL for unrested remainders. A symbol either matches
+// continuously or collects a call auction until uncross_all().
+// Every order enters through an internal ingest ring; stops activated by a trade
+// are pushed back onto the same ring, so cascades run through the normal matching
+// path ahead of the next inbound order.
+class MatchingEngine {
+public:
+    struct Config {
+        uint32_t min_price_cents = 5000;
+        uint32_t max_price_cents = 25000;
+        size_t max_resting_per_symbol = 1 << 16;
+        size_t max_stops_per_symbol = 1 << 14;
+        size_t max_symbols = 64;
+        size_t ingest_capacity = 1 << 12;
+        bool open_in_auction = false; // new symbols start in an opening call auction
+        bool trade_tape = false;      // collect TradePrints for drain_trades()
+        int64_t max_gross_exposure_cents = 0; // per account, at cost; needs a PositionKeeper, 0 = off
+    };
+private:
+    struct SymbolBooks {
+        std::unique_ptr<OrderBook> book;
+        std::unique_ptr<StopTriggerBook> stops;
+        uint32_t last_trade_cents = 0;
+    };
+    Config cfg_;
+    SymbolTable symbols_;
+    std::vector<SymbolBooks> books_;
+    OrderRingBuffer ingest_;
+    std::deque<Order> overflow_; // activations that found the ingest ring full
+    uint64_t cascade_ = 0;
+    std::vector<TradePrint> tape_;
+    PositionKeeper* positions_ = nullptr;
+    EngineStats stats_;
+public:
+    explicit MatchingEngine(const Config& cfg) : cfg_(cfg), symbols_(cfg.max_symbols), ingest_(cfg.ingest_capacity) {}
+
+    void process(const Order* orders, size_t n, std::vector<ExecReport>& out) {
+        for (size_t i = 0; i < n; ++i) {
+            stats_.orders++;
+            cascade_ = 0;
+            if (!ingest_.try_push(orders[i])) overflow_.push_back(orders[i]);
+            drain(out);
+            stats_.max_cascade = std::max(stats_.max_cascade, cascade_);
+        }
+    }
+
+    // Session close: expires resting DAY orders across all books.
+    void end_of_day(std::vector<ExecReport>& out) {
+        for (auto& sb : books_)
+            stats_.expired += sb.book->expire_day_orders([&](uint64_t id) {
+                out.push_back(ExecReport{id, 0, 0, 0, ExecType::CANCEL});
+            });
+    }
+
+    // Puts a symbol into call-auction mode, e.g. ahead of the close.
+    bool begin_auction(uint32_t symbol_id) {
+        if (symbol_id >= books_.size()) return false;
+        books_[symbol_id].book->set_auction(true);
+        return true;
+    }
+
+    // Uncrosses every symbol currently in auction and resumes continuous matching.
+    // Symbols first seen after this trade continuously: the opening auction is over.
+    void uncross_all(std::vector<ExecReport>& out) {
+        cfg_.open_in_auction = false;
+        for (auto& sb : books_)
+            if (sb.book->in_auction()) uncross(sb, out);
+    }
+
+    bool cancel(const Order& o) {
+        uint32_t id = symbols_.find(o.symbol);
+        return id != SymbolTable::INVALID && books_[id].book->cancel(o.order_id);
+    }
+
+    // Level changes across every book since the previous call, as
+    // on_change(symbol_id, side, price_cents, old_qty, new_qty). Matcher thread only.
+    template <typename OnChange>
+    void drain_depth_changes(OnChange&& on_change) {
+        for (uint32_t id = 0; id < books_.size(); ++id)
+            books_[id].book->drain_changes([&](OrderType side, uint32_t price, uint64_t old_qty, uint64_t new_qty) {
+                on_change(id, side, price, old_qty, new_qty);
+            });
+    }
+
+    // Fills update keeper's positions from here on, and new orders are checked
+    // against Config::max_gross_exposure_cents. The keeper must outlive the engine.
+    void set_position_keeper(PositionKeeper* keeper) { positions_ = keeper; }
+
+    // Trades executed since the previous call, oldest first. Needs Config::trade_tape.
+    template <typename OnTrade>
+    void drain_trades(OnTrade&& on_trade) {
+        for (const TradePrint& t : tape_) on_trade(t);
+        tape_.clear();
+    }
+
+    const EngineStats& stats() const { return stats_; }
+    const SymbolTable& symbols() const { return symbols_; }
+    const OrderBook* book(uint32_t symbol_id) const { return symbol_id < books_.size() ? books_[symbol_id].book.get() : nullptr; }
+    uint32_t last_trade(uint32_t symbol_id) const { return symbol_id < books_.size() ? books_[symbol_id].last_trade_cents : 0; }
+
+private:
+    void drain(std::vector<ExecReport>& out) {
+        Order o;
+        for (;;) {
+            if (ingest_.try_pop(o)) match_one(o, out);
+            else if (!overflow_.empty()) { o = overflow_.front(); overflow_.pop_front(); match_one(o, out); }
+            else break;
+        }
+    }
+
+    void match_one(const Order& o, std::vector<ExecReport>& out) {
+        SymbolBooks* sb = books_for(o);
+        if (!sb) { reject(o, out); return; }
+        bool triggered = o.flags & ORDER_FLAG_TRIGGERED;
+        if (!triggered && over_exposure(*sb, o)) { stats_.risk_rejects++; reject(o, out); return; }
+        size_t ack_pos = out.size();
+        if (!triggered) out.push_back(ExecReport{o.order_id, 0, 0, o.quantity, ExecType::ACK});
+        if (!triggered && (o.kind == OrderKind::STOP || o.kind == OrderKind::STOP_LIMIT)) {
+            if (StopTriggerBook::crossed(o, sb->last_trade_cents)) activate(o, out);
+            else if (sb->stops->arm(o)) stats_.stops_armed++;
+            else { out.resize(ack_pos); reject(o, out); }
+            return;
+        }
+        uint32_t low = UINT32_MAX, high = 0;
+        size_t match_pos = out.size();
+        auto start = std::chrono::steady_clock::now();
+        MatchResult r = sb->book->add(o, [&](const Fill& f) {
+            if (f.self_trade) {
+                // Prevented self-match: restate the resting order, and the taker when decremented.
+                stats_.self_trades_prevented++;
+                out.push_back(ExecReport{f.maker_id, f.qty, 0, f.maker_leaves, ExecType::CANCEL});
+                if (o.stp == StpMode::DECREMENT) out.push_back(ExecReport{f.taker_id, f.qty, 0, f.taker_leaves, ExecType::CANCEL});
+                return;
+            }
+            out.push_back(ExecReport{f.taker_id, f.qty, f.price_cents, f.taker_leaves, ExecType::FILL});
+            out.push_back(ExecReport{f.maker_id, f.qty, f.price_cents, f.maker_leaves, ExecType::FILL});
+            stats_.fills++;
+            stats_.filled_qty += f.qty;
+            low = std::min(low, f.price_cents);
+            high = std::max(high, f.price_cents);
+            sb->last_trade_cents = f.price_cents;
+            if (cfg_.trade_tape) print(*sb, start, f);
+            if (positions_) positions_->on_fill(symbol_id(*sb), f.buy_account, f.sell_account, f.qty, f.price_cents);
+        });
+        size_t tif = static_cast<size_t>(o.tif) % TIF_COUNT;
+        stats_.orders_by_tif[tif]++;
+        stats_.match_ns_by_tif[tif].record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        if (r.rejected && out.size() == match_pos) {
+            if (!triggered) out.resize(ack_pos);
+            reject(o, out);
+        } else if (r.cancelled || r.rejected) {
+            // Not rested after it traded or removed makers (pool full, order id still
+            // live): those stand, and the remainder is cancelled rather than lost.
+            stats_.cancelled++;
+            out.push_back(ExecReport{o.order_id, 0, 0, 0, ExecType::CANCEL});
+        }
+        if (r.filled && sb->stops->armed()) {
+            auto fire_start = std::chrono::steady_clock::now();
+            size_t fired = sb->stops->on_trade(low, high, [&](const Order& s) { activate(s, out); });
+            if (fired) stats_.trigger_ns.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - fire_start).count());
+        }
+    }
+
+    void uncross(SymbolBooks& sb, std::vector<ExecReport>& out) {
+        auto start = std::chrono::steady_clock::now();
+        UncrossResult r = sb.book->uncross(sb.last_trade_cents, [&](const Fill& f) {
+            out.push_back(ExecReport{f.taker_id, f.qty, f.price_cents, f.taker_leaves, ExecType::FILL});
+            out.push_back(ExecReport{f.maker_id, f.qty, f.price_cents, f.maker_leaves, ExecType::FILL});
+            stats_.fills++;
+            stats_.filled_qty += f.qty;
+            if (cfg_.trade_tape) print(sb, start, f);
+            if (positions_) positions_->on_fill(symbol_id(sb), f.buy_account, f.sell_account, f.qty, f.price_cents);
+        });
+        stats_.uncross_ns.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        stats_.auctions++;
+        stats_.auction_volume += r.volume;
+        // Market orders left over from the auction do not carry into continuous trading.
+        stats_.cancelled += sb.book->expire_if([](const Order& o) { return o.kind == OrderKind::MARKET; },
+            [&](uint64_t id) { out.push_back(ExecReport{id, 0, 0, 0, ExecType::CANCEL}); });
+        if (r.volume == 0) return;
+        sb.last_trade_cents = r.price_cents;
+        sb.stops->on_trade(r.price_cents, r.price_cents, [&](const Order& s) { activate(s, out); });
+        drain(out);
+    }
+
+    // Converts a stop into its active form and reinjects it through the ingest ring.
+    void activate(Order o, std::vector<ExecReport>& out) {
+        o.kind = o.kind == OrderKind::STOP ? OrderKind::MARKET : OrderKind::LIMIT;
+        o.flags |= ORDER_FLAG_TRIGGERED;
+        out.push_back(ExecReport{o.order_id, 0, 0, o.quantity, ExecType::TRIGGERED});
+        stats_.stops_triggered++;
+        cascade_++;
+        if (!ingest_.try_push(o)) overflow_.push_back(o);
+    }
+
+    SymbolBooks* books_for(const Order& o) {
+        uint32_t id = symbols_.intern(o.symbol);
+        if (id == SymbolTable::INVALID) return nullptr;
+        while (books_.size() <= id) {
+            SymbolBooks sb;
+            sb.book = std::make_unique<OrderBook>(cfg_.min_price_cents, cfg_.max_price_cents, cfg_.max_resting_per_symbol);
+            sb.stops = std::make_unique<StopTriggerBook>(cfg_.min_price_cents, cfg_.max_price_cents, cfg_.max_stops_per_symbol);
+            sb.book->set_auction(cfg_.open_in_auction);
+            books_.push_back(std::move(sb));
+        }
+        return &books_[id];
+    }
+    uint32_t symbol_id(const SymbolBooks& sb) const { return static_cast<uint32_t>(&sb - books_.data()); }
+    void print(const SymbolBooks& sb, std::chrono::steady_clock::time_point ts, const Fill& f) {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(ts.time_since_epoch()).count();
+        tape_.push_back(TradePrint{ns, symbol_id(sb), f.price_cents, f.qty});
+    }
+    // Pre-trade check against current at-cost exposure. Orders that only reduce the
+    // account's position in the symbol always pass. Stops are valued at their stop price
+    // and market orders at the far touch, else the last trade; a market order with
+    // neither has no price to check and fails.
+    bool over_exposure(const SymbolBooks& sb, const Order& o) const {
+        if (!positions_ || cfg_.max_gross_exposure_cents <= 0) return false;
+        int64_t pos = positions_->position(o.account_id, symbol_id(sb));
+        int64_t delta = o.type == OrderType::BUY ? o.quantity : -static_cast<int64_t>(o.quantity);
+        if (pos != 0 && (pos > 0) != (delta > 0) && std::llabs(delta) <= std::llabs(pos)) return false;
+        uint32_t px = o.price_cents;
+        if (o.kind == OrderKind::STOP) px = o.stop_price_cents;
+        else if (o.kind == OrderKind::MARKET) {
+            px = o.type == OrderType::BUY ? sb.book->best_ask_price() : sb.book->best_bid_price();
+            if (px == 0) px = sb.last_trade_cents;
+            if (px == 0) return true;
+        }
+        return positions_->gross_open_cost(o.account_id) + static_cast<int64_t>(px) * o.quantity > cfg_.max_gross_exposure_cents;
+    }
+    void reject(const Order& o, std::vector<ExecReport>& out) {
+        stats_.rejects++;
+        out.push_back(ExecReport{o.order_id, 0, 0, 0, ExecType::REJECT});
+    }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Intrusive multi-producer, single-consumer queue (Vyukov). Nodes embed MpscNode, so a
+// push allocates nothing. A push is one exchange on head_ plus one store linking the
+// previous node, so it is wait-free. Only the consumer touches tail_. pop() can return
+// nullptr while a push is between those two steps. The node then shows up on a later pop.
+struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+template <typename T>
+class MpscQueue {
+    alignas(64) std::atomic<MpscNode*> head_;  // producers: most recent node
+    alignas(64) MpscNode* tail_;               // consumer: oldest node, or the stub
+    MpscNode stub_;
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {}
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread.
+    void push(T* node) { push_node(node); }
+
+    // Consumer only: the oldest node, or nullptr if none is fully linked yet.
+    T* pop() {
+        MpscNode* tail = tail_;
+        MpscNode* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (!next) return nullptr;
+            tail_ = tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        if (tail != head_.load(std::memory_order_acquire)) return nullptr;  // a push is mid-way
+        // tail is the last node: put the stub behind it so tail can be handed out.
+        push_node(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (!next) return nullptr;
+        tail_ = next;
+        return static_cast<T*>(tail);
+    }
+private:
+    void push_node(MpscNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+};
+
+// Fixed pool of nodes for MpscQueue users. Nodes are preallocated, so the return path
+// never calls malloc. The free list is a Treiber stack. Its head packs a node index with
+// a change count, so a node freed and reused between another thread's load and CAS (ABA)
+// is detected. acquire() and release() are lock-free but not wait-free. acquire() returns
+// nullptr when the pool is empty.
+template <typename T>
+class NodePool {
+    static constexpr uint32_t NIL = UINT32_MAX;
+    std::unique_ptr<T[]> nodes_;
+    std::unique_ptr<std::atomic<uint32_t>[]> next_;
+    alignas(64) std::atomic<uint64_t> free_;  // tag << 32 | index
+    size_t capacity_;
+
+    static uint64_t pack(uint64_t tag, uint32_t index) { return tag << 32 | index; }
+public:
+    explicit NodePool(size_t capacity)
+        : nodes_(new T[capacity]), next_(new std::atomic<uint32_t>[capacity]), capacity_(capacity) {
+        for (size_t i = 0; i < capacity; ++i) next_[i].store(i + 1 < capacity ? static_cast<uint32_t>(i + 1) : NIL);
+        free_.store(pack(0, capacity ? 0 : NIL));
+    }
+
+    T* acquire() {
+        uint64_t head = free_.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t i = static_cast<uint32_t>(head);
+            if (i == NIL) return nullptr;
+            uint64_t next = pack((head >> 32) + 1, next_[i].load(std::memory_order_relaxed));
+            if (free_.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+                return &nodes_[i];
+        }
+    }
+    void release(T* node) {
+        uint32_t i = static_cast<uint32_t>(node - nodes_.get());
+        uint64_t head = free_.load(std::memory_order_relaxed);
+        do {
+            next_[i].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        } while (!free_.compare_exchange_weak(head, pack((head >> 32) + 1, i), std::memory_order_release,
+                                              std::memory_order_relaxed));
+    }
+    size_t capacity() const { return capacity_; }
+};
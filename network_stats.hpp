@@ -1,10 +1,50 @@
 #pragma once
 
+#include <cstdint>
+
+// Bottleneck link behind a simulated transport (see src/network_sim/link_model.hpp).
+struct LinkStats {
+    double bandwidth_mbps = 0.0;
+    uint32_t mtu_bytes = 0;
+    uint64_t batches = 0;
+    uint64_t packets = 0;            // after MTU fragmentation
+    uint64_t payload_bytes = 0;
+    uint64_t wire_bytes = 0;         // payload plus per-packet headers
+    uint64_t serialization_ns = 0;
+    uint64_t queueing_ns = 0;
+    uint64_t max_queue_bytes = 0;
+    uint64_t tail_drops = 0;         // queue full
+    uint64_t red_drops = 0;          // early drops under RED
+};
+
 struct TCPStats {
     int dropped_packets = 0;
     int retransmissions = 0;
     int base_delay_ms = 0;
     double drop_rate = 0.0;
+    LinkStats link;
+};
+
+// UDP reordering/duplication on the path and what the receiver's reorder buffer made of it.
+struct ReorderStats {
+    uint64_t window = 0;
+    uint64_t max_hold_us = 0;
+    uint64_t reordered = 0;          // injected on the path
+    uint64_t duplicated = 0;
+    uint64_t delivered = 0;          // released in sequence by the receiver
+    uint64_t held = 0;
+    uint64_t duplicates = 0;
+    uint64_t late = 0;
+    uint64_t lost = 0;
+    uint64_t hold_timeouts = 0;
+    uint64_t window_overflows = 0;
+    uint64_t max_pending = 0;
+    uint64_t max_displacement = 0;
+    uint64_t p50_hold_ns = 0;        // over held datagrams only
+    uint64_t p99_hold_ns = 0;
+    uint64_t max_hold_ns = 0;
+    uint64_t p50_delivery_ns = 0;    // send to in-sequence release, every datagram
+    uint64_t p99_delivery_ns = 0;
 };
 
 struct UDPStats {
@@ -12,6 +52,8 @@ struct UDPStats {
     int packets_dropped = 0;
     int base_delay_us = 0;
     double drop_rate = 0.0;
+    LinkStats link;
+    ReorderStats reorder;
 };
 
 struct SHMStats {
@@ -19,6 +61,71 @@ struct SHMStats {
     int noise_range_ns = 0;
 };
 
+// Round-trip view of a real loopback transport talking to the venue emulator.
+// Kernel software timestamps (SO_TIMESTAMPING) on a loopback client socket, splitting
+// each round trip into app->kernel (send call to TX stamp), kernel->kernel (TX stamp to
+// the reply's RX stamp: loopback path plus the venue) and kernel->app (RX stamp to the
+// reader having the frame).
+struct StackLatencyStats {
+    uint64_t tx_stamps = 0;
+    uint64_t rx_stamps = 0;
+    uint64_t unmatched = 0;          // send without a TX stamp, or reply to one
+    uint64_t p50_app_kernel_ns = 0;
+    uint64_t p99_app_kernel_ns = 0;
+    uint64_t p50_kernel_kernel_ns = 0;
+    uint64_t p99_kernel_kernel_ns = 0;
+    uint64_t p50_kernel_app_ns = 0;
+    uint64_t p99_kernel_app_ns = 0;
+};
+
+// Receive wait strategy of a socket reader thread and what it cost.
+struct RecvWaitStats {
+    const char* mode = "blocking";
+    bool kernel_busy_poll = false;   // SO_BUSY_POLL accepted by the socket
+    uint64_t empty_polls = 0;        // non-blocking reads that found nothing
+    uint64_t parks = 0;              // adaptive: epoll waits after the spin budget ran out
+    double cpu_pct = 0.0;            // reader thread CPU time over its run time
+};
+
+struct LoopbackStats {
+    uint64_t batches_sent = 0;
+    uint64_t batches_acked = 0;
+    uint64_t send_failures = 0;
+    uint64_t acks = 0;
+    uint64_t fills = 0;
+    uint64_t rejects = 0;
+    uint64_t cancels = 0;
+    uint64_t triggers = 0;
+    double avg_rtt_us = 0.0;
+    uint64_t p50_rtt_ns = 0;
+    uint64_t p99_rtt_ns = 0;
+    uint64_t max_rtt_ns = 0;
+    uint64_t captured_frames = 0;   // pcap capture, both directions
+    uint64_t capture_dropped = 0;
+    StackLatencyStats stack;
+    RecvWaitStats recv;
+};
+
+// A/B feed line handler: per-line arrivals and the arbitration outcome.
+struct FeedStats {
+    uint64_t published = 0;
+    uint64_t received_a = 0, received_b = 0;
+    uint64_t first_a = 0, first_b = 0;
+    uint64_t gaps_a = 0, gaps_b = 0;   // sequence numbers each line missed
+    uint64_t recovered = 0;            // line gaps filled from the other line
+    uint64_t lost = 0;
+    uint64_t unrecoverable_gaps = 0;
+    uint64_t duplicates = 0;
+    uint64_t delivered = 0;
+    uint64_t ring_full_waits = 0;
+    uint64_t p50_arb_ns = 0, p99_arb_ns = 0;   // arbitration per message (sampled)
+    uint64_t p50_feed_ns = 0, p99_feed_ns = 0; // publish to ring
+};
+
 TCPStats get_tcp_stats();
 UDPStats get_udp_stats();
-SHMStats get_shm_stats(); 
\ No newline at end of file
+SHMStats get_shm_stats(); 
+LoopbackStats get_tcp_loopback_stats();
+LoopbackStats get_udp_loopback_stats();
+LoopbackStats get_shm_loopback_stats();
+FeedStats get_ab_feed_stats();
@@ -10,6 +10,31 @@ enum class OrderType : uint8_t {
     SELL = 1
 };
 
+enum class TimeInForce : uint8_t {
+    DAY = 0, // rests until the session ends
+    GTC = 1, // rests until cancelled
+    IOC = 2, // fills what it can immediately, remainder cancelled
+    FOK = 3  // fills completely and immediately or not at all
+};
+constexpr size_t TIF_COUNT = 4;
+
+enum class OrderKind : uint8_t {
+    LIMIT = 0,
+    MARKET = 1,    // price_cents ignored; never rests
+    STOP = 2,      // becomes MARKET once the last trade crosses stop_price_cents
+    STOP_LIMIT = 3 // becomes LIMIT at price_cents once triggered
+};
+
+enum class StpMode : uint8_t {
+    NONE = 0,
+    CANCEL_NEWEST = 1, // the incoming order's remainder is cancelled
+    CANCEL_OLDEST = 2, // the resting order is cancelled, matching continues
+    DECREMENT = 3      // both lose the overlapping quantity without a trade
+};
+
+// Order::flags bits
+constexpr uint8_t ORDER_FLAG_TRIGGERED = 1 << 0; // activated stop being re-matched
+
 struct Order {
     uint64_t order_id;
     uint64_t timestamp_ns;
@@ -17,11 +42,23 @@ struct Order {
     uint32_t quantity;
     uint32_t price_cents;
     OrderType type;
-    Order() : order_id(0), timestamp_ns(0), quantity(0), price_cents(0), type(OrderType::BUY) {
+    TimeInForce tif;
+    OrderKind kind;
+    uint8_t flags;
+    uint32_t stop_price_cents;
+    uint32_t account_id;  // owner for self-trade prevention, 0 = anonymous
+    uint32_t display_qty; // iceberg peak, 0 = fully displayed
+    StpMode stp;
+    uint16_t client_id;   // ingress client for fair queuing, 0 = untagged
+    Order() : order_id(0), timestamp_ns(0), quantity(0), price_cents(0), type(OrderType::BUY),
+              tif(TimeInForce::DAY), kind(OrderKind::LIMIT), flags(0), stop_price_cents(0),
+              account_id(0), display_qty(0), stp(StpMode::NONE), client_id(0) {
         std::memset(symbol, 0, sizeof(symbol));
     }
-    Order(uint64_t id, const std::string& sym, OrderType t, double price, uint32_t qty)
-        : order_id(id), quantity(qty), type(t) {
+    Order(uint64_t id, const std::string& sym, OrderType t, double price, uint32_t qty,
+          TimeInForce tf = TimeInForce::DAY, OrderKind k = OrderKind::LIMIT)
+        : order_id(id), quantity(qty), type(t), tif(tf), kind(k), flags(0), stop_price_cents(0),
+          account_id(0), display_qty(0), stp(StpMode::NONE), client_id(0) {
         auto now = std::chrono::high_resolution_clock::now();
         timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
         std::strncpy(symbol, sym.c_str(), sizeof(symbol) - 1);
@@ -29,3 +66,6 @@ struct Order {
         price_cents = static_cast<uint32_t>(price * 100.0 + 0.5);
     }
 };
+
+// Exactly one cache line; 4 bytes of tail padding remain after client_id.
+static_assert(sizeof(Order) == 64, "Order layout grew");
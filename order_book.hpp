@@ -0,0 +1,417 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "order.hpp"
+#include "prefix_sum.hpp"
+
+struct Fill {
+    uint64_t taker_id;
+    uint64_t maker_id;
+    uint32_t qty;
+    uint32_t price_cents;
+    uint32_t taker_leaves;
+    uint32_t maker_leaves;
+    bool self_trade = false; // prevented self-match: qty was removed, not executed
+    uint32_t buy_account = 0;
+    uint32_t sell_account = 0;
+};
+
+struct MatchResult {
+    uint32_t filled = 0;
+    uint32_t rested = 0;
+    uint32_t cancelled = 0; // IOC/FOK/market/STP remainder that was never rested
+    uint32_t self_trade_qty = 0; // taker quantity removed by STP decrement
+    bool rejected = false;
+};
+
+struct UncrossResult {
+    uint32_t price_cents = 0;
+    uint64_t volume = 0;
+    uint64_t imbalance = 0; // |cumulative buy - cumulative sell| at the chosen price
+};
+
+// Price-time priority limit book over a dense one-cent price ladder.
+// Resting orders live in a preallocated node pool linked into per-level FIFOs and
+// are found by id through a preallocated open-addressing table, so matching and
+// cancels never allocate on the hot path.
+// Iceberg orders show display_qty at a time; when the peak is consumed it reloads
+// from reserve and requeues at the back of its level. Self-trade prevention is
+// applied per maker according to the taker's StpMode.
+// In call-auction mode orders rest without matching (the book may cross) until
+// uncross() executes everything at the single volume-maximizing price.
+class OrderBook {
+    static constexpr uint32_t NIL = UINT32_MAX;
+    struct Node {
+        Order order;
+        uint32_t leaves; // displayed + reserve
+        uint32_t shown;  // displayed part of leaves
+        uint32_t prev;
+        uint32_t next;
+    };
+    struct Level {
+        uint32_t head = NIL;
+        uint32_t tail = NIL;
+        uint32_t orders = 0;
+        uint64_t qty = 0;   // including iceberg reserve
+        uint64_t shown = 0; // displayed only
+        uint64_t published = 0; // shown as of the last drain_changes()
+        bool dirty = false;
+    };
+    uint32_t min_price_;
+    int64_t num_levels_;
+    std::vector<Level> bids_;
+    std::vector<Level> asks_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> dirty_; // touched levels: bid index, or num_levels_ + ask index
+    struct LiveSlot {
+        uint64_t order_id;
+        uint32_t node; // NIL: empty
+    };
+    std::vector<LiveSlot> live_; // order id -> node, linear probing, at most half full
+    int64_t best_bid_ = -1;
+    int64_t best_ask_;
+    bool auction_ = false;
+    std::vector<uint64_t> buy_cum_;  // auction scratch: cumulative bid qty, walking down from best bid
+    std::vector<uint64_t> sell_cum_; // auction scratch: cumulative ask qty, walking up from best ask
+public:
+    OrderBook(uint32_t min_price_cents, uint32_t max_price_cents, size_t max_resting)
+        : min_price_(min_price_cents), num_levels_(static_cast<int64_t>(max_price_cents) - min_price_cents + 1),
+          bids_(num_levels_), asks_(num_levels_), nodes_(max_resting), best_ask_(num_levels_) {
+        free_.reserve(max_resting);
+        for (size_t i = max_resting; i > 0; --i) free_.push_back(static_cast<uint32_t>(i - 1));
+        size_t cap = 1;
+        while (cap < max_resting * 2) cap <<= 1;
+        live_.assign(cap, LiveSlot{0, NIL});
+        dirty_.reserve(1024);
+    }
+
+    // Matches o against the opposite side, then rests any remainder.
+    // on_fill(const Fill&) is invoked once per maker touched, in execution order.
+    // Market orders sweep to the end of the ladder; IOC, FOK and market remainders
+    // are cancelled instead of rested, so a non-crossing IOC never touches the book.
+    template <typename OnFill>
+    MatchResult add(const Order& o, OnFill&& on_fill) {
+        MatchResult r;
+        bool buy = o.type == OrderType::BUY;
+        int64_t idx = o.kind == OrderKind::MARKET ? (buy ? num_levels_ - 1 : 0)
+                                                  : static_cast<int64_t>(o.price_cents) - min_price_;
+        if (o.quantity == 0 || idx < 0 || idx >= num_levels_) { r.rejected = true; return r; }
+        if (auction_) {
+            // Nothing executes before the uncross, so IOC/FOK can never fill; market orders
+            // rest at the far end of the ladder, i.e. at any price.
+            if (o.tif == TimeInForce::IOC || o.tif == TimeInForce::FOK) { r.cancelled = o.quantity; return r; }
+            if (free_.empty() || live_find(o.order_id) != NIL) { r.rejected = true; return r; }
+            rest(o, idx, o.quantity);
+            r.rested = o.quantity;
+            return r;
+        }
+        // FOK pre-check stops as soon as enough is found. It reads only per-level totals
+        // unless STP applies, so it never lets a FOK partially fill or cancel makers.
+        if (o.tif == TimeInForce::FOK && available(o, idx, o.quantity) < o.quantity) { r.cancelled = o.quantity; return r; }
+        uint32_t leaves = o.quantity;
+        bool halt = false; // STP cancel-newest hit
+        if (buy) {
+            while (leaves && !halt && best_ask_ <= idx) {
+                leaves = match_level(asks_[best_ask_], best_ask_, o, leaves, r, halt, on_fill);
+                while (best_ask_ < num_levels_ && asks_[best_ask_].orders == 0) ++best_ask_;
+            }
+        } else {
+            while (leaves && !halt && best_bid_ >= idx) {
+                leaves = match_level(bids_[best_bid_], best_bid_, o, leaves, r, halt, on_fill);
+                while (best_bid_ >= 0 && bids_[best_bid_].orders == 0) --best_bid_;
+            }
+        }
+        if (leaves == 0) return r;
+        if (halt || o.kind == OrderKind::MARKET || o.tif == TimeInForce::IOC || o.tif == TimeInForce::FOK) { r.cancelled = leaves; return r; }
+        if (free_.empty() || live_find(o.order_id) != NIL) { r.rejected = true; return r; }
+        rest(o, idx, leaves);
+        r.rested = leaves;
+        return r;
+    }
+
+    bool cancel(uint64_t order_id) {
+        uint32_t n = live_find(order_id);
+        if (n == NIL) return false;
+        int64_t idx = static_cast<int64_t>(nodes_[n].order.price_cents) - min_price_;
+        if (nodes_[n].order.type == OrderType::BUY) {
+            unlink(bids_[idx], n);
+            while (best_bid_ >= 0 && bids_[best_bid_].orders == 0) --best_bid_;
+        } else {
+            unlink(asks_[idx], n);
+            while (best_ask_ < num_levels_ && asks_[best_ask_].orders == 0) ++best_ask_;
+        }
+        return true;
+    }
+
+    // Drops every resting order matching pred, reporting each through on_expire(order_id).
+    template <typename Pred, typename OnExpire>
+    size_t expire_if(Pred&& pred, OnExpire&& on_expire) {
+        std::vector<uint64_t> expired;
+        for (const LiveSlot& s : live_)
+            if (s.node != NIL && pred(nodes_[s.node].order)) expired.push_back(s.order_id);
+        for (uint64_t id : expired) { cancel(id); on_expire(id); }
+        return expired.size();
+    }
+
+    // Session end: drops every resting DAY order.
+    template <typename OnExpire>
+    size_t expire_day_orders(OnExpire&& on_expire) {
+        return expire_if([](const Order& o) { return o.tif == TimeInForce::DAY; }, on_expire);
+    }
+
+    void set_auction(bool on) { auction_ = on; }
+    bool in_auction() const { return auction_; }
+
+    // Equilibrium price for the current (possibly crossed) book: maximizes executable
+    // volume min(cum_buy, cum_sell); ties go to the smallest imbalance, then to the price
+    // closest to reference_price_cents. Only [best ask, best bid] can execute, so the
+    // cumulative arrays cover just that span and are built with vectorized prefix sums.
+    UncrossResult equilibrium(uint32_t reference_price_cents) {
+        UncrossResult r;
+        if (!has_bid() || !has_ask() || best_bid_ < best_ask_) return r;
+        int64_t lo = best_ask_, hi = best_bid_;
+        size_t n = static_cast<size_t>(hi - lo + 1);
+        buy_cum_.resize(n);
+        sell_cum_.resize(n);
+        uint64_t* buy = buy_cum_.data();
+        uint64_t* sell = sell_cum_.data();
+        for (size_t i = 0; i < n; ++i) buy[i] = bids_[hi - static_cast<int64_t>(i)].qty;
+        for (size_t i = 0; i < n; ++i) sell[i] = asks_[lo + static_cast<int64_t>(i)].qty;
+        inclusive_prefix_sum(buy, n);
+        inclusive_prefix_sum(sell, n);
+        // At price lo + j: cumulative buy is buy[n - 1 - j], cumulative sell is sell[j].
+        uint64_t best = 0;
+        for (size_t j = 0; j < n; ++j) best = std::max(best, std::min(buy[n - 1 - j], sell[j]));
+        if (best == 0) return r;
+        int64_t ref = static_cast<int64_t>(reference_price_cents) - min_price_;
+        int64_t best_idx = -1;
+        uint64_t best_imbalance = UINT64_MAX;
+        for (size_t j = 0; j < n; ++j) {
+            uint64_t b = buy[n - 1 - j], s = sell[j];
+            if (std::min(b, s) != best) continue;
+            uint64_t imbalance = b > s ? b - s : s - b;
+            int64_t idx = lo + static_cast<int64_t>(j);
+            if (imbalance < best_imbalance ||
+                (imbalance == best_imbalance && std::abs(idx - ref) < std::abs(best_idx - ref))) {
+                best_imbalance = imbalance;
+                best_idx = idx;
+            }
+        }
+        r.price_cents = static_cast<uint32_t>(best_idx + min_price_);
+        r.volume = best;
+        r.imbalance = best_imbalance;
+        return r;
+    }
+
+    // Executes the auction at the equilibrium price in price-time priority on both sides
+    // and leaves auction mode. Fill::taker_id is the buyer, Fill::maker_id the seller.
+    template <typename OnFill>
+    UncrossResult uncross(uint32_t reference_price_cents, OnFill&& on_fill) {
+        UncrossResult r = equilibrium(reference_price_cents);
+        auction_ = false;
+        uint64_t remaining = r.volume;
+        while (remaining) {
+            Level& bl = bids_[best_bid_];
+            Level& al = asks_[best_ask_];
+            uint32_t bn = bl.head, an = al.head;
+            const Node& buyer = nodes_[bn];
+            const Node& seller = nodes_[an];
+            uint32_t qty = static_cast<uint32_t>(std::min<uint64_t>(std::min(buyer.leaves, seller.leaves), remaining));
+            remaining -= qty;
+            on_fill(Fill{buyer.order.order_id, seller.order.order_id, qty, r.price_cents, buyer.leaves - qty, seller.leaves - qty,
+                         false, buyer.order.account_id, seller.order.account_id});
+            consume(bl, bn, qty);
+            consume(al, an, qty);
+            while (best_bid_ >= 0 && bids_[best_bid_].orders == 0) --best_bid_;
+            while (best_ask_ < num_levels_ && asks_[best_ask_].orders == 0) ++best_ask_;
+        }
+        return r;
+    }
+
+    // Reports every level whose displayed quantity changed since the previous call as
+    // on_change(side, price_cents, old_qty, new_qty). Levels that changed and came back
+    // to the same quantity are skipped.
+    template <typename OnChange>
+    void drain_changes(OnChange&& on_change) {
+        for (uint32_t d : dirty_) {
+            bool bid = d < num_levels_;
+            int64_t idx = bid ? d : d - num_levels_;
+            Level& lvl = bid ? bids_[idx] : asks_[idx];
+            lvl.dirty = false;
+            if (lvl.shown == lvl.published) continue;
+            on_change(bid ? OrderType::BUY : OrderType::SELL, static_cast<uint32_t>(idx + min_price_), lvl.published, lvl.shown);
+            lvl.published = lvl.shown;
+        }
+        dirty_.clear();
+    }
+
+    bool has_bid() const { return best_bid_ >= 0; }
+    bool has_ask() const { return best_ask_ < num_levels_; }
+    uint32_t best_bid_price() const { return has_bid() ? static_cast<uint32_t>(best_bid_ + min_price_) : 0; }
+    uint32_t best_ask_price() const { return has_ask() ? static_cast<uint32_t>(best_ask_ + min_price_) : 0; }
+    // Displayed quantity only; iceberg reserve is not visible to market data.
+    uint64_t bid_qty_at(uint32_t price_cents) const { return level_at(bids_, price_cents).shown; }
+    uint64_t ask_qty_at(uint32_t price_cents) const { return level_at(asks_, price_cents).shown; }
+    size_t resting() const { return nodes_.size() - free_.size(); }
+    uint32_t min_price() const { return min_price_; }
+    uint32_t max_price() const { return static_cast<uint32_t>(min_price_ + num_levels_ - 1); }
+
+private:
+    template <typename OnFill>
+    uint32_t match_level(Level& lvl, int64_t idx, const Order& taker, uint32_t leaves, MatchResult& r, bool& halt, OnFill& on_fill) {
+        uint32_t price = static_cast<uint32_t>(idx + min_price_);
+        bool stp = taker.stp != StpMode::NONE && taker.account_id != 0;
+        while (leaves && lvl.head != NIL) {
+            uint32_t n = lvl.head;
+            const Node& maker = nodes_[n];
+            if (stp && maker.order.account_id == taker.account_id) {
+                if (taker.stp == StpMode::CANCEL_NEWEST) { halt = true; return leaves; }
+                uint32_t qty = maker.leaves;
+                if (taker.stp == StpMode::DECREMENT) {
+                    qty = std::min(leaves, maker.leaves);
+                    leaves -= qty;
+                    r.self_trade_qty += qty;
+                }
+                on_fill(Fill{taker.order_id, maker.order.order_id, qty, price, leaves, maker.leaves - qty, true});
+                consume(lvl, n, qty);
+                continue;
+            }
+            uint32_t qty = std::min(leaves, maker.shown);
+            leaves -= qty;
+            r.filled += qty;
+            uint32_t buyer = taker.type == OrderType::BUY ? taker.account_id : maker.order.account_id;
+            uint32_t seller = taker.type == OrderType::BUY ? maker.order.account_id : taker.account_id;
+            on_fill(Fill{taker.order_id, maker.order.order_id, qty, price, leaves, maker.leaves - qty, false, buyer, seller});
+            consume(lvl, n, qty);
+        }
+        return leaves;
+    }
+    void rest(const Order& o, int64_t idx, uint32_t leaves) {
+        uint32_t n = free_.back();
+        free_.pop_back();
+        Level& lvl = o.type == OrderType::BUY ? bids_[idx] : asks_[idx];
+        uint32_t shown = (o.display_qty && o.display_qty < leaves) ? o.display_qty : leaves;
+        nodes_[n] = Node{o, leaves, shown, NIL, NIL};
+        nodes_[n].order.price_cents = static_cast<uint32_t>(idx + min_price_); // market orders rest at the ladder end
+        link_back(lvl, n);
+        lvl.orders++;
+        lvl.qty += leaves;
+        lvl.shown += shown;
+        touch(lvl, o.type == OrderType::BUY);
+        live_[live_probe(o.order_id)] = LiveSlot{o.order_id, n};
+        if (o.type == OrderType::BUY) best_bid_ = std::max(best_bid_, idx);
+        else best_ask_ = std::min(best_ask_, idx);
+    }
+    // Takes qty off a resting order, unlinking it once empty. An iceberg whose
+    // displayed peak runs out reloads from reserve and loses time priority.
+    void consume(Level& lvl, uint32_t n, uint32_t qty) {
+        Node& node = nodes_[n];
+        uint32_t from_shown = std::min(qty, node.shown);
+        node.leaves -= qty;
+        node.shown -= from_shown;
+        lvl.qty -= qty;
+        lvl.shown -= from_shown;
+        touch(lvl, node.order.type == OrderType::BUY);
+        if (node.leaves == 0) { unlink(lvl, n); return; }
+        if (node.shown == 0) {
+            node.shown = std::min(node.order.display_qty, node.leaves);
+            lvl.shown += node.shown;
+            if (lvl.tail != n) { detach(lvl, n); link_back(lvl, n); }
+        }
+    }
+    // bid says which ladder lvl is in, so the index is taken within that array.
+    void touch(Level& lvl, bool bid) {
+        if (lvl.dirty) return;
+        lvl.dirty = true;
+        dirty_.push_back(static_cast<uint32_t>(bid ? &lvl - bids_.data() : num_levels_ + (&lvl - asks_.data())));
+    }
+    size_t live_home(uint64_t order_id) const {
+        return static_cast<size_t>((order_id * 0x9E3779B97F4A7C15ull) >> 32) & (live_.size() - 1);
+    }
+    // Slot holding order_id, or the empty slot that ends its probe run.
+    size_t live_probe(uint64_t order_id) const {
+        size_t mask = live_.size() - 1;
+        size_t i = live_home(order_id);
+        while (live_[i].node != NIL && live_[i].order_id != order_id) i = (i + 1) & mask;
+        return i;
+    }
+    uint32_t live_find(uint64_t order_id) const { return live_[live_probe(order_id)].node; }
+    // Backward-shift delete: later entries of the run move into the hole when their home
+    // slot allows it, so lookups never need tombstones.
+    void live_remove(uint64_t order_id) {
+        size_t mask = live_.size() - 1;
+        size_t hole = live_probe(order_id);
+        if (live_[hole].node == NIL) return;
+        for (size_t j = (hole + 1) & mask; live_[j].node != NIL; j = (j + 1) & mask) {
+            if (((j - live_home(live_[j].order_id)) & mask) >= ((j - hole) & mask)) {
+                live_[hole] = live_[j];
+                hole = j;
+            }
+        }
+        live_[hole].node = NIL;
+    }
+    void link_back(Level& lvl, uint32_t n) {
+        nodes_[n].prev = lvl.tail;
+        nodes_[n].next = NIL;
+        if (lvl.tail != NIL) nodes_[lvl.tail].next = n; else lvl.head = n;
+        lvl.tail = n;
+    }
+    void detach(Level& lvl, uint32_t n) {
+        Node& node = nodes_[n];
+        if (node.prev != NIL) nodes_[node.prev].next = node.next; else lvl.head = node.next;
+        if (node.next != NIL) nodes_[node.next].prev = node.prev; else lvl.tail = node.prev;
+    }
+    void unlink(Level& lvl, uint32_t n) {
+        Node& node = nodes_[n];
+        detach(lvl, n);
+        lvl.orders--;
+        lvl.qty -= node.leaves;
+        lvl.shown -= node.shown;
+        touch(lvl, node.order.type == OrderType::BUY);
+        live_remove(node.order.order_id);
+        free_.push_back(n);
+    }
+    // Opposite-side quantity the taker can trade at prices no worse than idx, capped once
+    // need is reached.
+    uint64_t available(const Order& taker, int64_t idx, uint64_t need) const {
+        bool buy = taker.type == OrderType::BUY;
+        uint64_t total = 0;
+        if (taker.stp == StpMode::NONE || taker.account_id == 0) {
+            if (buy) for (int64_t i = best_ask_; i <= idx && total < need; ++i) total += asks_[i].qty;
+            else for (int64_t i = best_bid_; i >= idx && total < need; --i) total += bids_[i].qty;
+            return total;
+        }
+        bool halt = false;
+        if (buy) for (int64_t i = best_ask_; i <= idx && total < need && !halt; ++i) total += tradable(asks_[i], taker, halt);
+        else for (int64_t i = best_bid_; i >= idx && total < need && !halt; --i) total += tradable(bids_[i], taker, halt);
+        return total;
+    }
+    // Quantity at lvl the taker would trade under STP. Same-account makers trade nothing:
+    // CANCEL_OLDEST removes them and goes on, while CANCEL_NEWEST and DECREMENT stop the
+    // fill there (halt). By then an iceberg ahead has shown only its peak; the rest of it
+    // reloads behind.
+    uint64_t tradable(const Level& lvl, const Order& taker, bool& halt) const {
+        uint64_t shown = 0, total = 0;
+        for (uint32_t n = lvl.head; n != NIL; n = nodes_[n].next) {
+            const Node& maker = nodes_[n];
+            if (maker.order.account_id != taker.account_id) {
+                shown += maker.shown;
+                total += maker.leaves;
+                continue;
+            }
+            if (taker.stp == StpMode::CANCEL_OLDEST) continue;
+            halt = true;
+            return shown;
+        }
+        return total;
+    }
+    const Level& level_at(const std::vector<Level>& side, uint32_t price_cents) const {
+        static const Level empty;
+        int64_t idx = static_cast<int64_t>(price_cents) - min_price_;
+        return (idx < 0 || idx >= num_levels_) ? empty : side[idx];
+    }
+};
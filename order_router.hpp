@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "order.hpp"
+
+enum class RoutePolicy : uint8_t {
+    COST,             // lowest fee for the order's size
+    LATENCY,          // lowest current latency estimate
+    FILL_PROBABILITY, // most likely to fill for the order's side and size
+    BLENDED           // fee + latency penalty + expected cost of not filling, all in mils
+};
+
+// Static description of one destination. Costs are in mils (1/1000 cent) per share,
+// fill probabilities in 1/65536 per [side][size bucket], bucket = floor(log2(qty)).
+struct VenueProfile {
+    static constexpr size_t QTY_BUCKETS = 11; // 1, 2-3, 4-7, ... 1024+
+    std::string name;
+    int32_t fee_mils_per_share = 0;   // negative = rebate
+    uint64_t latency_ns = 0;          // starting estimate, refined by observe_latency()
+    std::array<std::array<uint16_t, QTY_BUCKETS>, 2> fill_prob{};
+
+    // Same probability for both sides, falling by decay/65536 per size bucket.
+    static std::array<std::array<uint16_t, QTY_BUCKETS>, 2> fill_table(uint16_t base, uint16_t decay) {
+        std::array<std::array<uint16_t, QTY_BUCKETS>, 2> t{};
+        for (size_t b = 0; b < QTY_BUCKETS; ++b)
+            t[0][b] = t[1][b] = static_cast<uint16_t>(base > decay * b ? base - decay * b : 0);
+        return t;
+    }
+};
+
+// BLENDED conversion of latency and fill odds into mils.
+struct RouteWeights {
+    int64_t mils_per_us = 10;            // latency penalty per microsecond of estimate
+    int64_t miss_mils_per_share = 500;   // cost of a share that does not fill
+};
+
+// Per-order venue selection. Everything route() reads sits in a flat array of
+// cache-line-sized entries, so a decision is a few integer multiply-adds per venue
+// and no allocation or locking; latency estimates are updated with relaxed atomics
+// by whichever thread observes a send.
+class OrderRouter {
+public:
+    static constexpr size_t MAX_VENUES = 8;
+private:
+    struct alignas(64) VenueState {
+        int64_t fee_mils_per_share = 0;
+        std::atomic<uint64_t> latency_ns{0};
+        std::array<std::array<uint16_t, VenueProfile::QTY_BUCKETS>, 2> fill_prob{};
+    };
+    std::array<VenueState, MAX_VENUES> venues_;
+    std::vector<std::string> names_;
+    RoutePolicy policy_;
+    RouteWeights weights_;
+
+    static size_t qty_bucket(uint32_t qty) {
+        size_t b = static_cast<size_t>(31 - __builtin_clz(qty | 1));
+        return b < VenueProfile::QTY_BUCKETS ? b : VenueProfile::QTY_BUCKETS - 1;
+    }
+    int64_t score(const VenueState& v, size_t side, size_t bucket, int64_t qty) const {
+        int64_t fill = v.fill_prob[side][bucket];
+        switch (policy_) {
+            case RoutePolicy::COST: return v.fee_mils_per_share * qty;
+            case RoutePolicy::LATENCY: return static_cast<int64_t>(v.latency_ns.load(std::memory_order_relaxed));
+            case RoutePolicy::FILL_PROBABILITY: return -fill;
+            case RoutePolicy::BLENDED: break;
+        }
+        int64_t latency = static_cast<int64_t>(v.latency_ns.load(std::memory_order_relaxed)) * weights_.mils_per_us / 1000;
+        int64_t miss = ((65536 - fill) * qty * weights_.miss_mils_per_share) >> 16;
+        return v.fee_mils_per_share * qty + latency + miss;
+    }
+public:
+    OrderRouter(const std::vector<VenueProfile>& venues, RoutePolicy policy, RouteWeights weights = RouteWeights{})
+        : policy_(policy), weights_(weights) {
+        for (size_t i = 0; i < venues.size() && i < MAX_VENUES; ++i) {
+            venues_[i].fee_mils_per_share = venues[i].fee_mils_per_share;
+            venues_[i].latency_ns.store(venues[i].latency_ns, std::memory_order_relaxed);
+            venues_[i].fill_prob = venues[i].fill_prob;
+            names_.push_back(venues[i].name);
+        }
+    }
+
+    // Index of the best venue for o under the policy; ties go to the lower index.
+    uint32_t route(const Order& o) const {
+        size_t side = o.type == OrderType::SELL;
+        size_t bucket = qty_bucket(o.quantity);
+        int64_t qty = o.quantity;
+        uint32_t best = 0;
+        int64_t best_score = score(venues_[0], side, bucket, qty);
+        for (uint32_t i = 1; i < names_.size(); ++i) {
+            int64_t s = score(venues_[i], side, bucket, qty);
+            if (s < best_score) { best_score = s; best = i; }
+        }
+        return best;
+    }
+
+    // Feeds an observed send latency into the venue's estimate (EWMA, 1/8 weight).
+    void observe_latency(uint32_t venue, uint64_t ns) {
+        std::atomic<uint64_t>& est = venues_[venue].latency_ns;
+        uint64_t old = est.load(std::memory_order_relaxed);
+        est.store(old - (old >> 3) + (ns >> 3), std::memory_order_relaxed);
+    }
+
+    uint64_t latency_estimate(uint32_t venue) const { return venues_[venue].latency_ns.load(std::memory_order_relaxed); }
+    const std::string& name(uint32_t venue) const { return names_[venue]; }
+    size_t venues() const { return names_.size(); }
+    RoutePolicy policy() const { return policy_; }
+};
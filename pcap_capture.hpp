@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Wire-level capture of the loopback transports' frames, in classic pcap format with
+// nanosecond timestamps (magic 0xa1b23c4d) and raw IPv4 link type, so the file opens in
+// Wireshark/tcpdump as-is. Each frame is wrapped in synthetic 127.0.0.1 IPv4 + UDP/TCP
+// headers carrying the real ports; for TCP the sequence numbers are the per-direction
+// byte offsets, so the frames reassemble into the original stream.
+//
+// PcapWriter::write() only appends the record to an in-memory buffer under a short
+// lock; a background thread swaps buffers and does the file I/O. If the writer falls
+// more than max_pending bytes behind, records are dropped (counted), never waited for.
+
+constexpr uint32_t PCAP_MAGIC_NS = 0xa1b23c4d;
+constexpr uint32_t PCAP_MAGIC_US = 0xa1b2c3d4;
+constexpr uint32_t PCAP_LINKTYPE_IPV4 = 228;
+constexpr uint8_t PCAP_PROTO_TCP = 6;
+constexpr uint8_t PCAP_PROTO_UDP = 17;
+
+struct PcapFileHeader {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+};
+
+struct PcapRecordHeader {
+    uint32_t ts_sec;
+    uint32_t ts_frac;   // ns, or us in a microsecond file
+    uint32_t incl_len;
+    uint32_t orig_len;
+};
+
+struct PcapWriterStats {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;     // file bytes, headers included
+    uint64_t dropped = 0;   // writer too far behind
+};
+
+// Capture timestamps are wall clock so they line up with other captures of the host.
+inline uint64_t pcap_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+class PcapWriter {
+    std::FILE* file_ = nullptr;
+    std::thread writer_;
+    std::atomic<bool> running_{false};
+    std::mutex mutex_;              // pending_, tcp_seq_, stats_
+    std::vector<char> pending_;
+    size_t max_pending_;
+    uint32_t tcp_seq_[2] = {0, 0};  // byte offset per direction (0 = to the lower port)
+    uint16_t ip_id_ = 0;
+    PcapWriterStats stats_;
+
+    static void put16(char* p, uint16_t v) { p[0] = static_cast<char>(v >> 8); p[1] = static_cast<char>(v); }
+    static void put32(char* p, uint32_t v) { put16(p, static_cast<uint16_t>(v >> 16)); put16(p + 2, static_cast<uint16_t>(v)); }
+    static uint16_t ip_checksum(const char* p, size_t len) {
+        uint32_t sum = 0;
+        for (size_t i = 0; i + 1 < len; i += 2)
+            sum += (static_cast<uint8_t>(p[i]) << 8) | static_cast<uint8_t>(p[i + 1]);
+        while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+        return static_cast<uint16_t>(~sum);
+    }
+
+    void run() {
+        std::vector<char> out;
+        while (running_.load(std::memory_order_relaxed)) {
+            if (!flush(out)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        flush(out);
+    }
+    size_t flush(std::vector<char>& out) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            out.swap(pending_);
+        }
+        size_t n = out.size();
+        if (n) {
+            std::fwrite(out.data(), 1, n, file_);
+            std::fflush(file_);
+            out.clear();
+        }
+        return n;
+    }
+public:
+    explicit PcapWriter(size_t max_pending = 8 << 20) : max_pending_(max_pending) {}
+    ~PcapWriter() { close(); }
+
+    bool open(const std::string& path) {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) return false;
+        PcapFileHeader h{PCAP_MAGIC_NS, 2, 4, 0, 0, 65535, PCAP_LINKTYPE_IPV4};
+        std::fwrite(&h, sizeof(h), 1, file_);
+        running_ = true;
+        writer_ = std::thread(&PcapWriter::run, this);
+        return true;
+    }
+    // Writes out everything captured so far and closes the file.
+    void close() {
+        if (!running_.exchange(false)) return;
+        if (writer_.joinable()) writer_.join();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    // One frame of payload sent from src_port to dst_port at ts_ns (wall clock).
+    void write(uint64_t ts_ns, uint8_t proto, uint16_t src_port, uint16_t dst_port, const char* data, size_t len) {
+        size_t l4 = proto == PCAP_PROTO_TCP ? 20 : 8;
+        size_t pkt = 20 + l4 + len;
+        if (pkt > 65535) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.size() + sizeof(PcapRecordHeader) + pkt > max_pending_) {
+            stats_.dropped++;
+            return;
+        }
+        size_t at = pending_.size();
+        pending_.resize(at + sizeof(PcapRecordHeader) + pkt);
+        char* p = pending_.data() + at;
+        PcapRecordHeader rec{static_cast<uint32_t>(ts_ns / 1000000000), static_cast<uint32_t>(ts_ns % 1000000000),
+                             static_cast<uint32_t>(pkt), static_cast<uint32_t>(pkt)};
+        std::memcpy(p, &rec, sizeof(rec));
+        p += sizeof(rec);
+
+        // IPv4, 127.0.0.1 -> 127.0.0.1, don't fragment
+        std::memset(p, 0, 20 + l4);
+        p[0] = 0x45;
+        put16(p + 2, static_cast<uint16_t>(pkt));
+        put16(p + 4, ip_id_++);
+        put16(p + 6, 0x4000);
+        p[8] = 64;
+        p[9] = static_cast<char>(proto);
+        put32(p + 12, 0x7f000001);
+        put32(p + 16, 0x7f000001);
+        put16(p + 10, ip_checksum(p, 20));
+        char* t = p + 20;
+        put16(t, src_port);
+        put16(t + 2, dst_port);
+        if (proto == PCAP_PROTO_TCP) {
+            uint32_t& seq = tcp_seq_[src_port < dst_port ? 1 : 0];
+            put32(t + 4, seq);
+            put32(t + 8, tcp_seq_[src_port < dst_port ? 0 : 1]);
+            t[12] = 5 << 4;
+            t[13] = 0x18;   // PSH, ACK
+            put16(t + 14, 65535);
+            seq += static_cast<uint32_t>(len);
+        } else {
+            put16(t + 4, static_cast<uint16_t>(8 + len));
+        }
+        if (len) std::memcpy(p + 20 + l4, data, len);
+        stats_.frames++;
+        stats_.bytes += sizeof(rec) + pkt;
+    }
+
+    PcapWriterStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+};
+
+// One captured frame with the synthetic IPv4/L4 headers stripped.
+struct PcapFrame {
+    uint64_t ts_ns = 0;
+    uint8_t proto = 0;
+    uint16_t src_port = 0;
+    uint16_t dst_port = 0;
+    std::vector<char> payload;
+};
+
+// Sequential reader for files from PcapWriter (or any raw-IPv4 pcap without options).
+// Accepts microsecond and nanosecond files in host byte order.
+class PcapReader {
+    std::FILE* file_ = nullptr;
+    bool nanos_ = true;
+    std::vector<char> buf_;
+
+    static uint16_t get16(const char* p) {
+        return static_cast<uint16_t>((static_cast<uint8_t>(p[0]) << 8) | static_cast<uint8_t>(p[1]));
+    }
+public:
+    ~PcapReader() { if (file_) std::fclose(file_); }
+
+    bool open(const std::string& path) {
+        file_ = std::fopen(path.c_str(), "rb");
+        if (!file_) return false;
+        PcapFileHeader h;
+        if (std::fread(&h, sizeof(h), 1, file_) != 1) return false;
+        if (h.magic != PCAP_MAGIC_NS && h.magic != PCAP_MAGIC_US) return false;
+        nanos_ = h.magic == PCAP_MAGIC_NS;
+        return h.linktype == PCAP_LINKTYPE_IPV4;
+    }
+
+    // Next TCP or UDP frame; false at end of file or on a truncated record.
+    bool next(PcapFrame& f) {
+        PcapRecordHeader rec;
+        while (file_ && std::fread(&rec, sizeof(rec), 1, file_) == 1) {
+            buf_.resize(rec.incl_len);
+            if (rec.incl_len && std::fread(buf_.data(), 1, rec.incl_len, file_) != rec.incl_len) return false;
+            const char* p = buf_.data();
+            if (rec.incl_len < 20 || (p[0] >> 4) != 4) continue;
+            size_t ihl = static_cast<size_t>(p[0] & 0x0f) * 4;
+            uint8_t proto = static_cast<uint8_t>(p[9]);
+            size_t total = std::min<size_t>(get16(p + 2), rec.incl_len);
+            if (proto != PCAP_PROTO_TCP && proto != PCAP_PROTO_UDP) continue;
+            if (total < ihl + 8) continue;
+            const char* t = p + ihl;
+            size_t l4 = proto == PCAP_PROTO_TCP ? static_cast<size_t>(static_cast<uint8_t>(t[12]) >> 4) * 4 : 8;
+            if (total < ihl + l4) continue;
+            f.ts_ns = static_cast<uint64_t>(rec.ts_sec) * 1000000000 + rec.ts_frac * (nanos_ ? 1 : 1000);
+            f.proto = proto;
+            f.src_port = get16(t);
+            f.dst_port = get16(t + 2);
+            f.payload.assign(t + l4, p + total);
+            return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// Net position of one account in one symbol, average-cost basis.
+struct Position {
+    int64_t qty = 0;              // signed: long > 0, short < 0
+    int64_t open_cost_cents = 0;  // signed cost of the open qty (qty * avg price)
+    int64_t realized_cents = 0;
+    uint64_t traded_qty = 0;
+
+    int64_t unrealized_cents(uint32_t mark_cents) const { return qty * static_cast<int64_t>(mark_cents) - open_cost_cents; }
+};
+
+// Account totals derived from one consistent row and the current marks.
+struct Exposure {
+    int64_t gross_cents = 0;      // sum of |qty| * mark
+    int64_t net_cents = 0;        // sum of qty * mark
+    int64_t realized_cents = 0;
+    int64_t unrealized_cents = 0;
+};
+
+struct PositionKeeperStats {
+    uint64_t fills = 0;
+    uint64_t untracked = 0;       // fill sides whose account is 0 or beyond max_accounts
+    std::atomic<uint64_t> snapshots{0};
+    std::atomic<uint64_t> snapshot_retries{0};
+};
+
+// Positions per account x symbol in one dense array, row per account, updated in O(1)
+// per fill by the matcher thread. Each account row has its own sequence counter
+// (odd while being written), so other threads copy a consistent row without locks
+// and retry if the matcher wrote it meanwhile. Marks are the last trade price per
+// symbol and are applied when a snapshot is valued, never pushed into every row.
+class PositionKeeper {
+    struct alignas(64) AccountHeader {
+        std::atomic<uint64_t> seq{0};
+        int64_t gross_open_cost_cents = 0; // sum of |open_cost| across symbols, kept incrementally
+    };
+    const size_t max_accounts_;
+    const size_t max_symbols_;
+    std::unique_ptr<AccountHeader[]> headers_;
+    std::vector<Position> cells_;      // [account * max_symbols_ + symbol]
+    std::unique_ptr<std::atomic<uint32_t>[]> marks_;
+    PositionKeeperStats stats_;
+
+    Position& cell(uint32_t account, uint32_t symbol_id) { return cells_[account * max_symbols_ + symbol_id]; }
+
+    // Applies a signed quantity at price: closes against the open side first, realizing
+    // P&L on the closed part at average cost, then opens any remainder.
+    void apply(uint32_t account, uint32_t symbol_id, int64_t delta, uint32_t price_cents) {
+        AccountHeader& h = headers_[account];
+        Position& p = cell(account, symbol_id);
+        uint64_t seq = h.seq.load(std::memory_order_relaxed);
+        h.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        int64_t px = price_cents;
+        h.gross_open_cost_cents -= std::llabs(p.open_cost_cents);
+        if (p.qty != 0 && (p.qty > 0) != (delta > 0)) {
+            int64_t closing = std::min(std::llabs(delta), std::llabs(p.qty));
+            int64_t basis = p.open_cost_cents * closing / std::llabs(p.qty);
+            int64_t sign = p.qty > 0 ? 1 : -1;
+            p.realized_cents += sign * closing * px - basis;
+            p.open_cost_cents -= basis;
+            p.qty -= sign * closing;
+            delta += sign * closing;
+        }
+        p.qty += delta;
+        p.open_cost_cents += delta * px;
+        p.traded_qty += static_cast<uint64_t>(std::llabs(delta));
+        h.gross_open_cost_cents += std::llabs(p.open_cost_cents);
+        h.seq.store(seq + 2, std::memory_order_release);
+    }
+    bool tracked(uint32_t account) const { return account != 0 && account < max_accounts_; }
+public:
+    PositionKeeper(size_t max_accounts, size_t max_symbols)
+        : max_accounts_(max_accounts), max_symbols_(max_symbols), headers_(new AccountHeader[max_accounts]),
+          cells_(max_accounts * max_symbols), marks_(new std::atomic<uint32_t>[max_symbols]()) {}
+    PositionKeeper(const PositionKeeper&) = delete;
+    PositionKeeper& operator=(const PositionKeeper&) = delete;
+
+    // One execution between two accounts; either side may be untracked. Matcher thread only.
+    void on_fill(uint32_t symbol_id, uint32_t buy_account, uint32_t sell_account, uint32_t qty, uint32_t price_cents) {
+        if (symbol_id >= max_symbols_) return;
+        stats_.fills++;
+        marks_[symbol_id].store(price_cents, std::memory_order_relaxed);
+        int64_t q = qty;
+        if (tracked(buy_account)) apply(buy_account, symbol_id, q, price_cents); else stats_.untracked++;
+        if (tracked(sell_account)) apply(sell_account, symbol_id, -q, price_cents); else stats_.untracked++;
+    }
+
+    // At-cost gross exposure, O(1); for the pre-trade check on the matcher thread.
+    int64_t gross_open_cost(uint32_t account) const {
+        return tracked(account) ? headers_[account].gross_open_cost_cents : 0;
+    }
+    int64_t position(uint32_t account, uint32_t symbol_id) const {
+        return tracked(account) && symbol_id < max_symbols_ ? cells_[account * max_symbols_ + symbol_id].qty : 0;
+    }
+
+    // Copies the account's row (max_symbols positions) consistently; safe from any thread.
+    bool snapshot(uint32_t account, std::vector<Position>& out) {
+        if (!tracked(account)) return false;
+        const AccountHeader& h = headers_[account];
+        const Position* row = &cells_[account * max_symbols_];
+        out.resize(max_symbols_);
+        stats_.snapshots.fetch_add(1, std::memory_order_relaxed);
+        for (;;) {
+            uint64_t before = h.seq.load(std::memory_order_acquire);
+            if (!(before & 1)) {
+                for (size_t s = 0; s < max_symbols_; ++s) out[s] = row[s];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (h.seq.load(std::memory_order_relaxed) == before) return true;
+            }
+            stats_.snapshot_retries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Values a snapshot against the current marks.
+    Exposure exposure(uint32_t account) {
+        thread_local std::vector<Position> row;
+        Exposure e;
+        if (!snapshot(account, row)) return e;
+        for (size_t s = 0; s < max_symbols_; ++s) {
+            const Position& p = row[s];
+            int64_t mark = marks_[s].load(std::memory_order_relaxed);
+            e.gross_cents += std::llabs(p.qty) * mark;
+            e.net_cents += p.qty * mark;
+            e.realized_cents += p.realized_cents;
+            e.unrealized_cents += p.unrealized_cents(static_cast<uint32_t>(mark));
+        }
+        return e;
+    }
+
+    uint32_t mark(uint32_t symbol_id) const { return marks_[symbol_id].load(std::memory_order_relaxed); }
+    size_t max_accounts() const { return max_accounts_; }
+    size_t max_symbols() const { return max_symbols_; }
+    const PositionKeeperStats& stats() const { return stats_; }
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// In-place inclusive prefix sum over uint64 volumes (auction cumulative depth).
+inline void inclusive_prefix_sum_scalar(uint64_t* data, size_t n) {
+    uint64_t run = 0;
+    for (size_t i = 0; i < n; ++i) { run += data[i]; data[i] = run; }
+}
+
+#if defined(__AVX2__)
+// Four lanes per step: two shift-and-add rounds scan inside the register, then the
+// running total from the previous step is broadcast-added. Keeps the serial
+// dependency to one vector add per 4 elements instead of one scalar add per element.
+inline void inclusive_prefix_sum(uint64_t* data, size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i carry = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i t = _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03);
+        x = _mm256_add_epi64(x, t);
+        t = _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F);
+        x = _mm256_add_epi64(_mm256_add_epi64(x, t), carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), x);
+        carry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    uint64_t run = i ? data[i - 1] : 0;
+    for (; i < n; ++i) { run += data[i]; data[i] = run; }
+}
+#else
+inline void inclusive_prefix_sum(uint64_t* data, size_t n) { inclusive_prefix_sum_scalar(data, n); }
+#endif
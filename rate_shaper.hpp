@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "order.hpp"
+#include "wire.hpp"
+#include "tsc_clock.hpp"
+#include "latency_histogram.hpp"
+
+// Venue egress limits. One message is one batch frame on the wire.
+struct ShaperConfig {
+    double msgs_per_sec = 500.0;
+    double bytes_per_sec = 4.0e6;
+    uint32_t burst_msgs = 16;
+    uint32_t burst_bytes = 64 * 1024;
+    size_t max_merge_orders = 64;   // held batches merge into one message up to this size
+};
+
+struct ShaperStats {
+    uint64_t submitted = 0;         // batches from the batcher
+    uint64_t sent_msgs = 0;
+    uint64_t sent_orders = 0;
+    uint64_t sent_bytes = 0;
+    uint64_t held = 0;              // batches that had to wait for the bucket
+    uint64_t merged = 0;            // batches folded into an earlier held one
+    uint64_t max_queue = 0;
+    uint64_t queued = 0;            // still waiting when the stats were taken
+    LatencyHistogram delay_ns;      // submit to release, every batch (0 when not held)
+};
+
+// Per-destination token-bucket shaper between the batcher and the transport. Each limit
+// is a GCRA in TSC ticks: it keeps the theoretical time the bucket is empty again, and a
+// message conforms when adding its cost stays within the burst allowance of now. There
+// are no timers: submit() sends straight through when it conforms and nothing is queued,
+// otherwise the batch waits (merged into the tail message if there is room) until a
+// later submit() or poll() finds the bucket refilled. Releasing and sending happen under
+// one send lock, so held and direct messages reach the transport one at a time and in
+// submit order, and the transport needs no locking of its own.
+class RateShaper {
+public:
+    using SendFn = std::function<void(const std::vector<Order>&, uint64_t)>;
+private:
+    struct Held {
+        std::vector<Order> orders;
+        std::vector<uint64_t> since_tsc;   // submit time of each batch merged in
+        uint64_t batch_latency_us;
+    };
+    struct Bucket {
+        uint64_t cost_q16;      // ticks per unit, 16.16 fixed point
+        uint64_t allowance;     // burst in ticks
+        uint64_t tat = 0;       // theoretical arrival time
+        uint64_t cost(uint64_t units) const { return (units * cost_q16) >> 16; }
+        // An idle bucket always admits one message, so a frame larger than the burst still goes.
+        bool fits(uint64_t now, uint64_t units) const { return tat <= now || tat + cost(units) <= now + allowance; }
+        void take(uint64_t now, uint64_t units) { tat = std::max(tat, now) + cost(units); }
+    };
+    ShaperConfig cfg_;
+    SendFn send_;
+    Bucket msgs_, bytes_;
+    std::mutex send_mutex_;   // held from release through send_: one sender at a time, in FIFO order
+    std::mutex mutex_;        // queue_, buckets and stats_
+    std::deque<Held> queue_;
+    ShaperStats stats_;
+
+    static Bucket make_bucket(double per_sec, uint32_t burst) {
+        double ticks = tsc_ticks_per_ns() * 1e9 / per_sec;
+        Bucket b;
+        b.cost_q16 = static_cast<uint64_t>(ticks * 65536.0);
+        b.allowance = static_cast<uint64_t>(ticks * burst);
+        return b;
+    }
+    static uint64_t frame_bytes(size_t orders) { return sizeof(WireHeader) + orders * sizeof(Order); }
+    bool conforms(uint64_t now, size_t orders) const {
+        return msgs_.fits(now, 1) && bytes_.fits(now, frame_bytes(orders));
+    }
+    void account(uint64_t now, size_t orders) {
+        msgs_.take(now, 1);
+        bytes_.take(now, frame_bytes(orders));
+        stats_.sent_msgs++;
+        stats_.sent_orders += orders;
+        stats_.sent_bytes += frame_bytes(orders);
+    }
+    // Moves every head message that now conforms into out (caller sends outside the lock).
+    void release(uint64_t now, std::vector<Held>& out) {
+        while (!queue_.empty() && conforms(now, queue_.front().orders.size())) {
+            account(now, queue_.front().orders.size());
+            for (uint64_t since : queue_.front().since_tsc) stats_.delay_ns.record(tsc_to_ns(now - since));
+            out.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+    }
+public:
+    RateShaper(const ShaperConfig& cfg, SendFn send)
+        : cfg_(cfg), send_(std::move(send)), msgs_(make_bucket(cfg.msgs_per_sec, cfg.burst_msgs)),
+          bytes_(make_bucket(cfg.bytes_per_sec, cfg.burst_bytes)) {}
+
+    // Batcher send callback.
+    void submit(const std::vector<Order>& batch, uint64_t batch_latency_us) {
+        std::lock_guard<std::mutex> sending(send_mutex_);
+        std::vector<Held> ready;
+        bool direct = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            uint64_t now = tsc_now();
+            stats_.submitted++;
+            release(now, ready);
+            if (queue_.empty() && conforms(now, batch.size())) {
+                account(now, batch.size());
+                stats_.delay_ns.record(0);
+                direct = true;
+            } else if (!queue_.empty() && queue_.back().orders.size() + batch.size() <= cfg_.max_merge_orders) {
+                queue_.back().orders.insert(queue_.back().orders.end(), batch.begin(), batch.end());
+                queue_.back().since_tsc.push_back(now);
+                stats_.held++;
+                stats_.merged++;
+            } else {
+                queue_.push_back(Held{batch, {now}, batch_latency_us});
+                stats_.held++;
+                stats_.max_queue = std::max<uint64_t>(stats_.max_queue, queue_.size());
+            }
+        }
+        for (const Held& h : ready) send_(h.orders, h.batch_latency_us);
+        if (direct) send_(batch, batch_latency_us);
+    }
+
+    // Releases held messages the buckets now admit; call from the sending loop. Returns
+    // at once if another thread is sending; that thread releases what conforms first.
+    void poll() {
+        std::unique_lock<std::mutex> sending(send_mutex_, std::try_to_lock);
+        if (!sending.owns_lock()) return;
+        std::vector<Held> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.empty()) return;
+            release(tsc_now(), ready);
+        }
+        for (const Held& h : ready) send_(h.orders, h.batch_latency_us);
+    }
+
+    // Shutdown, once nothing submits any more: sends every held message, still within
+    // the limits, so this can take up to queued / msgs_per_sec.
+    void drain() {
+        for (;;) {
+            poll();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (queue_.empty()) return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    ShaperStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ShaperStats s = stats_;
+        s.queued = queue_.size();
+        return s;
+    }
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "order.hpp"
+#include "latency_histogram.hpp"
+
+// Receiver-side duplicate filter: remembers the last `window` sequence numbers and
+// admits each one once. Safe for concurrent arrivals from several paths.
+class FirstArrivalFilter {
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_; // seq + 1 of the last admitted sequence per slot
+    const size_t mask_;
+public:
+    explicit FirstArrivalFilter(size_t window) : slots_(new std::atomic<uint64_t>[window]()), mask_(window - 1) {}
+    // True for the first copy of seq, false for any later one.
+    bool accept(uint64_t seq) {
+        std::atomic<uint64_t>& slot = slots_[seq & mask_];
+        uint64_t cur = slot.load(std::memory_order_acquire);
+        while (cur < seq + 1)
+            if (slot.compare_exchange_weak(cur, seq + 1, std::memory_order_acq_rel)) return true;
+        return false;
+    }
+    bool seen(uint64_t seq) const { return slots_[seq & mask_].load(std::memory_order_acquire) >= seq + 1; }
+};
+
+struct PathStats {
+    std::string name;
+    uint64_t sent = 0;        // copies handed to the transport
+    uint64_t delivered = 0;
+    uint64_t lost = 0;
+    uint64_t won = 0;         // copies that arrived first
+    uint64_t suppressed = 0;  // copies skipped because another path had already delivered
+    LatencyHistogram latency_ns; // enqueue to arrival, delivered copies only
+};
+
+struct RedundancyStats {
+    uint64_t batches = 0;
+    uint64_t unique = 0;      // batches that arrived over at least one path
+    uint64_t duplicates = 0;  // later copies discarded by the receiver
+    uint64_t bytes_unique = 0;
+    uint64_t bytes_sent = 0;  // across all paths
+    LatencyHistogram first_ns; // enqueue to first arrival
+    std::vector<PathStats> paths;
+};
+
+// Sends every batch over all paths at once and delivers the first copy to arrive.
+// Each path has its own worker thread and queue, so a slow path never delays a fast
+// one; send() returns as soon as one copy has arrived (or every path failed), and a
+// queued copy whose sequence already arrived elsewhere is dropped before transmit.
+class RedundantSender {
+public:
+    using SendFn = std::function<bool(const std::vector<Order>&, uint64_t)>;
+private:
+    struct Ticket {
+        uint64_t seq;
+        uint64_t enqueue_ns;
+        uint64_t batch_latency_us;
+        std::vector<Order> batch;
+        std::atomic<bool> arrived{false};
+        std::atomic<size_t> failed{0};
+    };
+    struct Path {
+        SendFn send;
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Ticket>> queue;
+        PathStats stats;
+        std::thread worker;
+    };
+    std::vector<std::unique_ptr<Path>> paths_;
+    FirstArrivalFilter filter_;
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> next_seq_{0};
+    std::mutex stats_mutex_;
+    RedundancyStats stats_;
+
+    static uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    void run(Path& p) {
+        while (running_) {
+            std::shared_ptr<Ticket> t;
+            {
+                std::lock_guard<std::mutex> lock(p.mutex);
+                if (!p.queue.empty()) { t = std::move(p.queue.front()); p.queue.pop_front(); }
+            }
+            if (!t) { std::this_thread::sleep_for(std::chrono::microseconds(10)); continue; }
+            if (filter_.seen(t->seq)) {
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                p.stats.suppressed++;
+                continue;
+            }
+            bool ok = p.send(t->batch, t->batch_latency_us);
+            uint64_t latency = now_ns() - t->enqueue_ns;
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            p.stats.sent++;
+            stats_.bytes_sent += t->batch.size() * sizeof(Order);
+            if (!ok) { p.stats.lost++; t->failed++; continue; }
+            p.stats.delivered++;
+            p.stats.latency_ns.record(latency);
+            if (filter_.accept(t->seq)) {
+                p.stats.won++;
+                stats_.unique++;
+                stats_.bytes_unique += t->batch.size() * sizeof(Order);
+                stats_.first_ns.record(latency);
+                t->arrived = true;
+            } else {
+                stats_.duplicates++;
+            }
+        }
+    }
+public:
+    RedundantSender(const std::vector<std::pair<std::string, SendFn>>& paths, size_t window = 1 << 16)
+        : filter_(window) {
+        for (const auto& [name, send] : paths) {
+            auto p = std::make_unique<Path>();
+            p->send = send;
+            p->stats.name = name;
+            paths_.push_back(std::move(p));
+        }
+        for (auto& p : paths_) p->worker = std::thread([this, path = p.get()] { run(*path); });
+    }
+    ~RedundantSender() { stop(); }
+    RedundantSender(const RedundantSender&) = delete;
+    RedundantSender& operator=(const RedundantSender&) = delete;
+
+    // Fans the batch out to every path and waits for the first arrival. Returns false
+    // when every path lost it.
+    bool send(const std::vector<Order>& batch, uint64_t batch_latency_us) {
+        auto t = std::make_shared<Ticket>();
+        t->seq = next_seq_++;
+        t->enqueue_ns = now_ns();
+        t->batch_latency_us = batch_latency_us;
+        t->batch = batch;
+        for (auto& p : paths_) {
+            std::lock_guard<std::mutex> lock(p->mutex);
+            p->queue.push_back(t);
+        }
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.batches++;
+        }
+        while (running_ && !t->arrived && t->failed < paths_.size()) std::this_thread::yield();
+        return t->arrived;
+    }
+
+    void stop() {
+        if (!running_.exchange(false)) return;
+        for (auto& p : paths_) if (p->worker.joinable()) p->worker.join();
+    }
+
+    RedundancyStats stats() {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        RedundancyStats s = stats_;
+        for (auto& p : paths_) s.paths.push_back(p->stats);
+        return s;
+    }
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include "sequence_window.hpp"
+
+struct ReorderBufferStats {
+    uint64_t received = 0;
+    uint64_t delivered = 0;
+    uint64_t in_order = 0;          // released on arrival
+    uint64_t held = 0;              // arrived ahead of a gap and waited in the window
+    uint64_t duplicates = 0;
+    uint64_t late = 0;              // arrived after its gap was given up
+    uint64_t lost = 0;              // sequence numbers skipped
+    uint64_t hold_timeouts = 0;     // gaps given up after max_hold_ns
+    uint64_t window_overflows = 0;  // gaps given up because the window filled
+    uint64_t max_pending = 0;
+    uint64_t max_displacement = 0;  // furthest ahead of the next expected sequence
+};
+
+// Receiver-side reorder buffer for a sequenced datagram stream (sequences start at 1).
+// Items are released in sequence order; anything that arrives early waits in a fixed
+// window (SequenceWindow). A gap is given up once the first item held behind it has
+// waited max_hold_ns, or when an arrival lands too far ahead to fit. An arrival behind
+// the head is told apart as a duplicate (delivered earlier) or late (its gap was skipped).
+// Single-threaded: the caller serializes push(), poll() and flush().
+template <typename T>
+class ReorderBuffer {
+    struct Held {
+        uint64_t arrival_ns = 0;
+        T item{};
+    };
+    SequenceWindow<Held> window_;
+    const uint64_t max_hold_ns_;
+    uint64_t blocked_since_ns_ = 0; // arrival of the first item held behind the head gap
+    ReorderBufferStats stats_;
+
+    // Releases everything now contiguous and restarts the hold clock on what still waits.
+    template <typename Emit>
+    void drain(uint64_t now_ns, Emit& emit) {
+        window_.release([&](const Held& h) {
+            emit(h.item, now_ns - h.arrival_ns);
+            stats_.delivered++;
+        });
+        if (window_.pending()) blocked_since_ns_ = window_.first_pending().arrival_ns;
+    }
+    template <typename Emit>
+    void skip_gap(uint64_t now_ns, Emit& emit) {
+        stats_.lost += window_.skip_gap();
+        drain(now_ns, emit);
+    }
+public:
+    ReorderBuffer(size_t window, uint64_t max_hold_ns) : window_(window), max_hold_ns_(max_hold_ns) {}
+
+    // emit(const T&, uint64_t held_ns) receives every item at most once, in sequence order.
+    template <typename Emit>
+    void push(uint64_t seq, uint64_t now_ns, const T& item, Emit&& emit) {
+        stats_.received++;
+        uint64_t next = window_.next();
+        if (seq < next || window_.holds(seq)) {
+            if (seq >= next || (window_.holds(seq) && next - seq < window_.size())) stats_.duplicates++;
+            else stats_.late++;
+            // Any arrival moves the clock, so a hold that has run out ends here too.
+            poll(now_ns, emit);
+            return;
+        }
+        stats_.max_displacement = std::max(stats_.max_displacement, seq - next);
+        if (seq == next) {
+            stats_.in_order++;
+            window_.pass(seq);
+            emit(item, 0);
+            stats_.delivered++;
+            drain(now_ns, emit);
+            return;
+        }
+        auto release = [&](const Held& h) {
+            emit(h.item, now_ns - h.arrival_ns);
+            stats_.delivered++;
+        };
+        if (window_.make_room(seq, release, [&](uint64_t lost) { stats_.window_overflows++; stats_.lost += lost; }) &&
+            window_.pending())
+            blocked_since_ns_ = window_.first_pending().arrival_ns;
+        stats_.held++;
+        window_.hold(seq, Held{now_ns, item});
+        if (window_.pending() == 1) blocked_since_ns_ = now_ns;
+        stats_.max_pending = std::max(stats_.max_pending, window_.pending());
+        poll(now_ns, emit);
+    }
+
+    // Gives up gaps whose blocked items have waited max_hold_ns; call with the clock
+    // when nothing arrives.
+    template <typename Emit>
+    void poll(uint64_t now_ns, Emit&& emit) {
+        while (window_.pending() && now_ns - blocked_since_ns_ >= max_hold_ns_) {
+            stats_.hold_timeouts++;
+            skip_gap(now_ns, emit);
+        }
+    }
+
+    // End of stream: gives up every remaining gap and releases everything still held.
+    template <typename Emit>
+    void flush(uint64_t now_ns, Emit&& emit) {
+        while (window_.pending()) skip_gap(now_ns, emit);
+    }
+
+    uint64_t next_expected() const { return window_.next(); }
+    uint64_t pending() const { return window_.pending(); }
+    const ReorderBufferStats& stats() const { return stats_; }
+};
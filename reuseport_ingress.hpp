@@ -0,0 +1,217 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include "order.hpp"
+#include "ring_buffer.hpp"
+#include "wire.hpp"
+#include "latency_histogram.hpp"
+#include "src/network_loopback/loopback_common.hpp"
+
+struct ReceiverStats {
+    int cpu = -1;                // pinned core, -1 if pinning failed
+    uint64_t datagrams = 0;
+    uint64_t bad = 0;            // wrong size/magic or unknown client
+    uint64_t reordered = 0;      // client seq went backwards on this receiver
+    uint64_t gaps = 0;           // client seqs skipped (socket buffer overflow)
+    uint64_t ring_full_waits = 0;
+    uint32_t clients = 0;        // distinct clients hashed to this receiver
+    RecvWaitStats recv;
+};
+
+struct ReuseportIngressStats {
+    std::vector<ReceiverStats> receivers;
+    uint64_t split_clients = 0;  // clients seen by more than one receiver
+    uint64_t p50_ingress_ns = 0; // client send to decoded, sampled
+    uint64_t p99_ingress_ns = 0;
+};
+
+// Pins t to cpu (modulo the online cores); returns the core or -1.
+inline int pin_thread(std::thread& t, int cpu) {
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores == 0) return -1;
+    cpu %= static_cast<int>(cores);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(t.native_handle(), sizeof(set), &set) == 0 ? cpu : -1;
+}
+
+// Multi-threaded UDP order entry. Each receiver thread owns a socket bound to the same
+// port with SO_REUSEPORT, is pinned to its own core and decodes into its own SPSC ring,
+// so receivers share nothing. The kernel picks the socket by hashing the flow's
+// addresses and ports, so every datagram from one client socket lands on the same
+// receiver and a client's orders stay in order through its ring. That is checked
+// rather than assumed: per-client seqs are tracked on each receiver, and a client
+// turning up on a second receiver is counted as split.
+class ReuseportIngress {
+    struct Receiver {
+        int fd = -1;
+        int cpu = -1;
+        AdaptiveRingBuffer* out;
+        std::thread thread;
+        std::atomic<uint64_t> datagrams{0};
+        uint64_t bad = 0, reordered = 0, gaps = 0, ring_full_waits = 0;
+        uint32_t clients = 0;
+        std::vector<uint64_t> last_seq;  // by client_id
+        LatencyHistogram ingress_ns;
+        SocketWaiter wait;
+        pthread_t handle{};
+        RecvWaitStats recv;              // taken at stop, while the thread still exists
+        explicit Receiver(AdaptiveRingBuffer* o, size_t max_clients) : out(o), last_seq(max_clients + 1, 0) {}
+    };
+    static constexpr int BATCH = 32;  // datagrams per recvmmsg
+    std::vector<std::unique_ptr<Receiver>> rx_;
+    std::unique_ptr<std::atomic<int>[]> owner_;  // client_id -> first receiver to see it
+    size_t max_clients_;
+    uint16_t port_;
+    std::atomic<uint64_t> split_{0};
+    std::atomic<bool> running_{false};
+    std::chrono::steady_clock::time_point started_;
+
+    void receive(Receiver& r, int index) {
+        std::vector<IngressPacket> pkts(BATCH);
+        mmsghdr msgs[BATCH] = {};
+        iovec iov[BATCH];
+        for (int i = 0; i < BATCH; ++i) {
+            iov[i] = iovec{&pkts[i], sizeof(IngressPacket)};
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        uint64_t n = 0;
+        while (running_.load(std::memory_order_relaxed)) {
+            int got = recvmmsg(r.fd, msgs, BATCH, MSG_WAITFORONE | r.wait.recv_flags(), nullptr);
+            if (got <= 0) {          // nothing yet, or the receive timeout: recheck running_
+                r.wait.on_empty();
+                continue;
+            }
+            r.wait.on_data();
+            for (int i = 0; i < got; ++i) {
+                const IngressPacket& p = pkts[i];
+                uint16_t c = p.order.client_id;
+                if (msgs[i].msg_len != sizeof(IngressPacket) || p.magic != WIRE_MAGIC || c == 0 || c > max_clients_) {
+                    r.bad++;
+                    continue;
+                }
+                uint64_t& last = r.last_seq[c];
+                if (last == 0) {
+                    r.clients++;
+                    int expected = -1;
+                    if (!owner_[c].compare_exchange_strong(expected, index) && expected != index) split_++;
+                }
+                if (p.seq <= last) r.reordered++;
+                else {
+                    r.gaps += p.seq - last - 1;
+                    last = p.seq;
+                }
+                if ((n++ & 63) == 0) r.ingress_ns.record(wire_now_ns() - p.send_ts_ns);
+                // Back pressure: the datagrams queue in the socket buffer meanwhile. Spin
+                // briefly, then sleep so a receiver sharing a core with its consumer lets it run.
+                for (int tries = 0; !r.out->try_push(p.order); ++tries) {
+                    r.ring_full_waits++;
+                    if (!running_.load(std::memory_order_relaxed)) return;
+                    if (tries < 64) std::this_thread::yield();
+                    else std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+                r.datagrams.fetch_add(1, std::memory_order_relaxed);
+            }
+            r.out->flush();  // the ring publishes lazily; make this batch visible before blocking again
+        }
+    }
+public:
+    // One receiver per ring; ring i is fed only by receiver i. Clients are 1..max_clients.
+    ReuseportIngress(uint16_t port, const std::vector<AdaptiveRingBuffer*>& rings, size_t max_clients)
+        : owner_(new std::atomic<int>[max_clients + 1]), max_clients_(max_clients), port_(port) {
+        for (size_t c = 0; c <= max_clients; ++c) owner_[c] = -1;
+        for (AdaptiveRingBuffer* ring : rings) rx_.push_back(std::make_unique<Receiver>(ring, max_clients));
+    }
+    ~ReuseportIngress() {
+        stop();
+        for (auto& r : rx_) if (r->fd >= 0) close(r->fd);
+    }
+
+    // Binds every socket before any receiver runs, so the reuseport group is complete
+    // (and the flow hash stable) before the first datagram. Receiver i goes on core first_cpu + i.
+    bool start(int first_cpu = 0, RecvMode mode = RecvMode::BLOCKING, uint32_t spin_us = 200) {
+        for (auto& r : rx_) {
+            r->fd = socket(AF_INET, SOCK_DGRAM, 0);
+            if (r->fd < 0) return false;
+            int one = 1, rcvbuf = 4 << 20;
+            if (setsockopt(r->fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) return false;
+            setsockopt(r->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+            sockaddr_in addr = loopback_addr(port_);
+            if (bind(r->fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+            set_recv_timeout(r->fd, 100);
+            r->wait.setup(r->fd, mode, spin_us);
+        }
+        running_ = true;
+        started_ = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rx_.size(); ++i) {
+            Receiver& r = *rx_[i];
+            r.thread = std::thread(&ReuseportIngress::receive, this, std::ref(r), static_cast<int>(i));
+            r.handle = r.thread.native_handle();
+            r.cpu = pin_thread(r.thread, first_cpu + static_cast<int>(i));
+        }
+        return true;
+    }
+    void stop() {
+        if (!running_.exchange(false)) return;
+        auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started_).count();
+        for (auto& r : rx_) r->recv = r->wait.get_stats(thread_cpu_ns(r->handle), static_cast<uint64_t>(wall));
+        for (auto& r : rx_) if (r->thread.joinable()) r->thread.join();
+    }
+
+    uint64_t received() const {
+        uint64_t n = 0;
+        for (auto& r : rx_) n += r->datagrams.load(std::memory_order_relaxed);
+        return n;
+    }
+    // Read once stopped.
+    ReuseportIngressStats stats() const {
+        ReuseportIngressStats s;
+        LatencyHistogram all;
+        for (auto& r : rx_) {
+            ReceiverStats rs;
+            rs.cpu = r->cpu;
+            rs.datagrams = r->datagrams.load();
+            rs.bad = r->bad;
+            rs.reordered = r->reordered;
+            rs.gaps = r->gaps;
+            rs.ring_full_waits = r->ring_full_waits;
+            rs.clients = r->clients;
+            rs.recv = r->recv;
+            s.receivers.push_back(rs);
+            all.merge(r->ingress_ns);
+        }
+        s.split_clients = split_.load();
+        s.p50_ingress_ns = all.percentile(50);
+        s.p99_ingress_ns = all.percentile(99);
+        return s;
+    }
+};
+
+// One order entry client: its own UDP socket, so one flow and one receiver.
+class IngressSender {
+    int fd_ = -1;
+    uint64_t seq_ = 0;
+    sockaddr_in dst_{};
+public:
+    ~IngressSender() { if (fd_ >= 0) close(fd_); }
+    bool open(uint16_t port) {
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) return false;
+        dst_ = loopback_addr(port);
+        return connect(fd_, reinterpret_cast<sockaddr*>(&dst_), sizeof(dst_)) == 0;
+    }
+    bool send(const Order& o) {
+        IngressPacket p{WIRE_MAGIC, 0, ++seq_, wire_now_ns(), o};
+        return ::send(fd_, &p, sizeof(p), 0) == static_cast<ssize_t>(sizeof(p));
+    }
+    uint64_t sent() const { return seq_; }
+};
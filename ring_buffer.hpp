@@ -41,3 +41,207 @@ public:
     size_t capacity() const { return capacity_; }
     void clear() { head_.store(0, std::memory_order_relaxed); tail_.store(0, std::memory_order_relaxed); }
 };
+
+// OrderRingBuffer with head_ and tail_ on their own cache lines, and each side keeping
+// a copy of the other's index: the shared line is only read when the copy says the ring
+// looks full (producer) or empty (consumer). Same interface for the SPSC benchmarks.
+class CachedIndexRingBuffer {
+    std::unique_ptr<Order[]> buffer_;
+    const size_t capacity_;
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;   // producer's copy
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;   // consumer's copy
+public:
+    explicit CachedIndexRingBuffer(size_t capacity) : capacity_(capacity) {
+        assert((capacity & (capacity - 1)) == 0 && "Capacity must be a power of 2");
+        buffer_ = std::make_unique<Order[]>(capacity);
+    }
+    bool try_push(const Order& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t next = (head + 1) & (capacity_ - 1);
+        if (next == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (next == cached_tail_) return false;
+        }
+        buffer_[head] = item;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+    bool try_pop(Order& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) return false;
+        }
+        item = buffer_[tail];
+        tail_.store((tail + 1) & (capacity_ - 1), std::memory_order_release);
+        return true;
+    }
+    size_t capacity() const { return capacity_; }
+};
+
+// Index-free SPSC ring (FastForward, with B-Queue's batched probing on the producer).
+// Each slot carries a full flag next to its order; the producer fills a slot and sets
+// the flag, the consumer takes the order and clears it. Neither index is shared, so the
+// only lines that move between cores are the slots themselves. The consumer frees slots
+// in order, so when the producer finds slot head+b-1 empty, all b slots up to it are
+// free: it probes batch_ slots ahead and halves the distance on a full probe, and checks
+// no flag again until the batch is used. Slots are 128 bytes (a 64-byte order plus the
+// flag), aligned so that neighbouring slots never share a line. Holds capacity orders.
+class SlotFlagRingBuffer {
+    struct alignas(64) Slot {
+        std::atomic<bool> full{false};
+        Order order;
+    };
+    std::unique_ptr<Slot[]> slots_;
+    const size_t capacity_;
+    const size_t batch_;
+    alignas(64) size_t head_ = 0;      // producer only
+    size_t batch_end_ = 0;             // slots before this are known free
+    alignas(64) size_t tail_ = 0;      // consumer only
+
+    bool probe() {
+        for (size_t b = batch_; b > 0; b >>= 1) {
+            if (!slots_[(head_ + b - 1) & (capacity_ - 1)].full.load(std::memory_order_acquire)) {
+                batch_end_ = head_ + b;
+                return true;
+            }
+        }
+        return false;
+    }
+public:
+    explicit SlotFlagRingBuffer(size_t capacity)
+        : slots_(new Slot[capacity]), capacity_(capacity),
+          batch_(capacity >= 1024 ? 256 : capacity >= 4 ? capacity / 4 : 1) {
+        assert((capacity & (capacity - 1)) == 0 && "Capacity must be a power of 2");
+    }
+    bool try_push(const Order& item) {
+        if (head_ == batch_end_ && !probe()) return false;
+        Slot& s = slots_[head_ & (capacity_ - 1)];
+        s.order = item;
+        s.full.store(true, std::memory_order_release);
+        head_++;
+        return true;
+    }
+    bool try_pop(Order& item) {
+        Slot& s = slots_[tail_ & (capacity_ - 1)];
+        if (!s.full.load(std::memory_order_acquire)) return false;
+        item = s.order;
+        s.full.store(false, std::memory_order_release);
+        tail_++;
+        return true;
+    }
+    // Consumer side.
+    bool empty() const { return !slots_[tail_ & (capacity_ - 1)].full.load(std::memory_order_acquire); }
+    size_t capacity() const { return capacity_; }
+};
+
+// SPSC ring that publishes its indices lazily. The producer makes its writes visible
+// (stores head_) every publish_every pushes. It publishes at once if the consumer has
+// flagged itself idle, and also when the ring is full. The consumer likewise returns
+// slots (stores tail_) every publish_every pops. It returns them at once when the
+// producer has flagged it is blocked on a full ring, and when the ring runs empty. A
+// flag is cleared by the side that answers it, so one signal costs one early store. At
+// high load each index line moves between cores once per publish_every messages instead
+// of once per message. A consumer that is already idle sees the next push straight away.
+// A push made before the consumer goes idle is not, and stays unpublished (see try_push).
+// A producer must therefore flush() before it goes idle itself. Each side also caches the
+// other's index, as in CachedIndexRingBuffer.
+class AdaptiveRingBuffer {
+    std::unique_ptr<Order[]> buffer_;
+    const size_t capacity_;
+    const size_t publish_every_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<bool> consumer_idle_{false};
+    alignas(64) std::atomic<bool> producer_blocked_{false};
+    // producer only
+    alignas(64) size_t local_head_ = 0;
+    size_t cached_tail_ = 0;
+    size_t unpublished_ = 0;
+    uint64_t head_publishes_ = 0;
+    // consumer only
+    alignas(64) size_t local_tail_ = 0;
+    size_t cached_head_ = 0;
+    size_t unreturned_ = 0;
+    uint64_t tail_publishes_ = 0;
+
+    void publish_head() {
+        head_.store(local_head_, std::memory_order_release);
+        unpublished_ = 0;
+        head_publishes_++;
+    }
+    void publish_tail() {
+        tail_.store(local_tail_, std::memory_order_release);
+        unreturned_ = 0;
+        tail_publishes_++;
+    }
+public:
+    explicit AdaptiveRingBuffer(size_t capacity, size_t publish_every = 16)
+        : capacity_(capacity), publish_every_(publish_every ? publish_every : 1) {
+        assert((capacity & (capacity - 1)) == 0 && "Capacity must be a power of 2");
+        buffer_ = std::make_unique<Order[]>(capacity);
+    }
+    // Unpublished window: the idle flag is read relaxed and no fence pairs it with the
+    // consumer's seq_cst store. A fence here would not close the window anyway, because
+    // an unpublished push makes no store the consumer could see. If the consumer is still
+    // busy when this push reads the flag, the push stays invisible. The consumer then runs
+    // empty and flags itself idle without seeing it. The push becomes visible only at
+    // the next push that reads the flag as set, at the publish_every-th push, or at
+    // flush(). There is no bound in time, so call flush() before waiting on anything.
+    bool try_push(const Order& item) {
+        size_t next = (local_head_ + 1) & (capacity_ - 1);
+        if (next == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (next == cached_tail_) {
+                if (unpublished_) publish_head();
+                if (!producer_blocked_.load(std::memory_order_relaxed)) producer_blocked_.store(true, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        if (producer_blocked_.load(std::memory_order_relaxed)) producer_blocked_.store(false, std::memory_order_relaxed);
+        buffer_[local_head_] = item;
+        local_head_ = next;
+        if (++unpublished_ >= publish_every_) {
+            publish_head();
+        } else if (consumer_idle_.load(std::memory_order_relaxed)) {
+            publish_head();
+            consumer_idle_.store(false, std::memory_order_relaxed);  // answered; it sets it again once drained
+        }
+        return true;
+    }
+    // Producer: publishes anything pushed but not yet visible. Call before going idle.
+    // Returns whether there was anything to publish.
+    bool flush() {
+        if (!unpublished_) return false;
+        publish_head();
+        return true;
+    }
+    bool try_pop(Order& item) {
+        if (local_tail_ == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (local_tail_ == cached_head_) {
+                if (unreturned_) publish_tail();
+                if (!consumer_idle_.load(std::memory_order_relaxed)) {
+                    consumer_idle_.store(true, std::memory_order_seq_cst);
+                    cached_head_ = head_.load(std::memory_order_acquire);
+                }
+                if (local_tail_ == cached_head_) return false;
+            }
+        }
+        if (consumer_idle_.load(std::memory_order_relaxed)) consumer_idle_.store(false, std::memory_order_relaxed);
+        item = buffer_[local_tail_];
+        local_tail_ = (local_tail_ + 1) & (capacity_ - 1);
+        if (++unreturned_ >= publish_every_) {
+            publish_tail();
+        } else if (producer_blocked_.load(std::memory_order_relaxed)) {
+            publish_tail();
+            producer_blocked_.store(false, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    size_t capacity() const { return capacity_; }
+    // Index stores by both sides so far; read once both are quiescent.
+    uint64_t publications() const { return head_publishes_ + tail_publishes_; }
+};
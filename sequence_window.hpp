@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// Fixed window over a sequenced stream (sequences start at 1): the release and gap
+// bookkeeping shared by FeedArbiter and ReorderBuffer. Entries that arrive ahead of
+// next() wait in a slot until everything before them is released or given up; the
+// owner decides when a gap is given up. Slots keep the sequence number of what they
+// last held, so an earlier sequence is still recognized until its slot is reused.
+// Single-threaded, like its owners.
+template <typename T>
+class SequenceWindow {
+    struct Slot {
+        uint64_t seq = 0;
+        T value{};
+    };
+    std::vector<Slot> slots_;
+    const uint64_t mask_;
+    uint64_t next_ = 1;
+    uint64_t pending_ = 0;
+public:
+    explicit SequenceWindow(size_t window) : slots_(window), mask_(window - 1) {
+        assert((window & (window - 1)) == 0 && "Window must be a power of 2");
+    }
+
+    uint64_t next() const { return next_; }
+    uint64_t pending() const { return pending_; }
+    uint64_t size() const { return mask_ + 1; }
+    // Held now if seq >= next(); otherwise released or passed, with its slot not reused since.
+    bool holds(uint64_t seq) const { return slots_[seq & mask_].seq == seq; }
+    // Oldest held entry; only while pending() > 0.
+    const T& first_pending() const {
+        uint64_t s = next_;
+        while (slots_[s & mask_].seq != s) s++;
+        return slots_[s & mask_].value;
+    }
+
+    // seq == next(), delivered by the owner on arrival.
+    void pass(uint64_t seq) {
+        slots_[seq & mask_].seq = seq;
+        next_++;
+    }
+    // seq > next() and within the window (see make_room).
+    void hold(uint64_t seq, const T& value) {
+        slots_[seq & mask_] = Slot{seq, value};
+        pending_++;
+    }
+    // Hands every held entry now contiguous with next() to emit(const T&).
+    template <typename Emit>
+    void release(Emit&& emit) {
+        while (pending_ && slots_[next_ & mask_].seq == next_) {
+            pending_--;
+            emit(slots_[next_ & mask_].value);
+            next_++;
+        }
+    }
+    // Declares [next(), limit) lost, stopping early at the first held entry, and returns
+    // how many sequence numbers that gave up. The limit may be unbounded only while
+    // something is held.
+    uint64_t skip_gap(uint64_t limit = UINT64_MAX) {
+        assert((pending_ || limit != UINT64_MAX) && "Unbounded gap with nothing held");
+        uint64_t from = next_;
+        while (next_ < limit && slots_[next_ & mask_].seq != next_) next_++;
+        return next_ - from;
+    }
+    // Too far ahead to buffer: gives up the oldest gaps until seq fits, releasing what
+    // each one unblocks through emit. on_gap(uint64_t lost) sees every gap given up;
+    // returns how many there were.
+    template <typename Emit, typename OnGap>
+    uint64_t make_room(uint64_t seq, Emit&& emit, OnGap&& on_gap) {
+        uint64_t gaps = 0;
+        while (seq - next_ > mask_) {
+            on_gap(skip_gap(pending_ ? UINT64_MAX : seq - mask_));
+            gaps++;
+            release(emit);
+        }
+        return gaps;
+    }
+};
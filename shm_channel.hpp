@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Single-producer/single-consumer ring of length-prefixed frames, laid out
+// directly in POSIX shared memory so two processes can exchange batches.
+struct ShmFrameRing {
+    static constexpr size_t SLOT_BYTES = 64 * 1024;
+    static constexpr size_t SLOTS = 64;
+    struct Slot {
+        uint32_t len;
+        char data[SLOT_BYTES - sizeof(uint32_t)];
+    };
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) Slot slots[SLOTS];
+
+    bool try_write(const char* data, size_t len) {
+        if (len > sizeof(Slot::data)) return false;
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == SLOTS) return false;
+        Slot& s = slots[h % SLOTS];
+        s.len = static_cast<uint32_t>(len);
+        std::memcpy(s.data, data, len);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    // Copies the next frame into out (resized to fit); false when empty.
+    bool try_read(std::string& out) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        const Slot& s = slots[t % SLOTS];
+        out.assign(s.data, s.len);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "SHM rings need address-free atomics");
+
+struct ShmVenueLayout {
+    static constexpr uint32_t READY = 0x52454459;
+    std::atomic<uint32_t> ready;
+    ShmFrameRing to_venue;
+    ShmFrameRing to_client;
+};
+
+// RAII mapping of a named segment. The venue creates it, clients attach to it.
+class ShmSegment {
+    std::string name_;
+    ShmVenueLayout* layout_ = nullptr;
+    bool owner_ = false;
+public:
+    ShmSegment() = default;
+    ShmSegment(const ShmSegment&) = delete;
+    ShmSegment& operator=(const ShmSegment&) = delete;
+    ~ShmSegment() {
+        if (layout_) munmap(layout_, sizeof(ShmVenueLayout));
+        if (owner_) shm_unlink(name_.c_str());
+    }
+    bool create(const std::string& name) {
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) return false;
+        bool ok = ftruncate(fd, sizeof(ShmVenueLayout)) == 0 && map(fd);
+        close(fd);
+        if (!ok) { shm_unlink(name.c_str()); return false; }
+        name_ = name;
+        owner_ = true;
+        layout_->to_venue.head.store(0);
+        layout_->to_venue.tail.store(0);
+        layout_->to_client.head.store(0);
+        layout_->to_client.tail.store(0);
+        layout_->ready.store(ShmVenueLayout::READY, std::memory_order_release);
+        return true;
+    }
+    bool attach(const std::string& name) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0) return false;
+        bool ok = map(fd);
+        close(fd);
+        if (ok && layout_->ready.load(std::memory_order_acquire) != ShmVenueLayout::READY) {
+            munmap(layout_, sizeof(ShmVenueLayout));
+            layout_ = nullptr;
+            return false;
+        }
+        name_ = name;
+        return ok;
+    }
+    ShmVenueLayout* layout() const { return layout_; }
+private:
+    bool map(int fd) {
+        void* p = mmap(nullptr, sizeof(ShmVenueLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return false;
+        layout_ = static_cast<ShmVenueLayout*>(p);
+        return true;
+    }
+};
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include "order.hpp"
+#include "ring_buffer.hpp"
+#include "feed_arbiter.hpp"
+#include "async_logger.hpp"
+#include "src/network_loopback/loopback_common.hpp"
+
+// Redundant A/B order feed over loopback UDP. A replay source publishes one sequenced
+// stream on two lines, dropping packets on each line independently; the line handler
+// arbitrates both sockets into one gap-free (where possible) stream in the order ring.
+class ABFeed {
+    int src_fd_ = -1;
+    int line_fd_[2] = {-1, -1};
+    uint16_t ports_[2];
+    std::atomic<bool> running_{false};
+    std::thread source_, handler_;
+    std::function<Order()> next_order_;
+    double loss_[2];
+    int interval_us_;
+    OrderRingBuffer* out_;
+    FeedArbiter arbiter_;
+    std::atomic<uint64_t> published_{0};
+    uint64_t ring_full_waits_ = 0;
+    LatencyHistogram arb_ns_, feed_ns_;
+public:
+    ABFeed(OrderRingBuffer* out, std::function<Order()> next_order, double loss_a, double loss_b, int interval_us)
+        : ports_{FEED_A_PORT, FEED_B_PORT}, next_order_(std::move(next_order)), loss_{loss_a, loss_b},
+          interval_us_(interval_us), out_(out) {}
+    ~ABFeed() {
+        stop();
+        for (int fd : {src_fd_, line_fd_[0], line_fd_[1]}) if (fd >= 0) close(fd);
+    }
+    bool start() {
+        src_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        for (int l = 0; l < 2; ++l) {
+            line_fd_[l] = socket(AF_INET, SOCK_DGRAM, 0);
+            int rcvbuf = 4 << 20;
+            setsockopt(line_fd_[l], SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+            sockaddr_in addr = loopback_addr(ports_[l]);
+            if (bind(line_fd_[l], reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+        }
+        if (src_fd_ < 0) return false;
+        running_ = true;
+        handler_ = std::thread(&ABFeed::handle_lines, this);
+        source_ = std::thread(&ABFeed::publish, this);
+        return true;
+    }
+    void stop() {
+        if (!running_.exchange(false)) return;
+        if (source_.joinable()) source_.join();
+        if (handler_.joinable()) handler_.join();
+    }
+    FeedStats get_stats() const {
+        const ArbiterStats& a = arbiter_.stats();
+        FeedStats s;
+        s.published = published_;
+        s.received_a = a.received[0];
+        s.received_b = a.received[1];
+        s.first_a = a.first[0];
+        s.first_b = a.first[1];
+        s.gaps_a = a.line_gaps[0];
+        s.gaps_b = a.line_gaps[1];
+        s.recovered = a.recovered();
+        s.lost = a.lost;
+        s.unrecoverable_gaps = a.unrecoverable_gaps;
+        s.duplicates = a.duplicates;
+        s.delivered = a.delivered;
+        s.ring_full_waits = ring_full_waits_;
+        s.p50_arb_ns = arb_ns_.percentile(50);
+        s.p99_arb_ns = arb_ns_.percentile(99);
+        s.p50_feed_ns = feed_ns_.percentile(50);
+        s.p99_feed_ns = feed_ns_.percentile(99);
+        return s;
+    }
+private:
+    void publish() {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> drop(0.0, 1.0);
+        FeedPacket pkt{};
+        pkt.magic = WIRE_MAGIC;
+        uint64_t seq = 0;
+        while (running_) {
+            pkt.order = next_order_();
+            pkt.seq = ++seq;
+            pkt.send_ts_ns = wire_now_ns();
+            for (uint32_t l = 0; l < 2; ++l) {
+                if (drop(rng) < loss_[l]) continue;
+                pkt.line = l;
+                sockaddr_in addr = loopback_addr(ports_[l]);
+                sendto(src_fd_, &pkt, sizeof(pkt), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            }
+            published_++;
+            std::this_thread::sleep_for(std::chrono::microseconds(interval_us_));
+        }
+    }
+    // Busy-polls both lines; whichever has a packet goes through the arbiter.
+    void handle_lines() {
+        FeedPacket pkt;
+        uint64_t n = 0;
+        auto emit = [&](const Order& o) {
+            while (!out_->try_push(o)) {
+                ring_full_waits_++;
+                if (!running_) return;
+                std::this_thread::yield();
+            }
+        };
+        while (running_) {
+            bool idle = true;
+            for (int l = 0; l < 2; ++l) {
+                ssize_t len = recv(line_fd_[l], &pkt, sizeof(pkt), MSG_DONTWAIT);
+                if (len != static_cast<ssize_t>(sizeof(pkt)) || pkt.magic != WIRE_MAGIC) continue;
+                idle = false;
+                // Time one message in 64 so the clock reads do not dominate the path being measured.
+                if ((n++ & 63) == 0) {
+                    uint64_t t0 = wire_now_ns();
+                    arbiter_.on_message(static_cast<size_t>(l), pkt.seq, pkt.order, emit);
+                    uint64_t t1 = wire_now_ns();
+                    arb_ns_.record(t1 - t0);
+                    feed_ns_.record(t1 - pkt.send_ts_ns);
+                } else {
+                    arbiter_.on_message(static_cast<size_t>(l), pkt.seq, pkt.order, emit);
+                }
+            }
+            if (idle) std::this_thread::yield();
+        }
+    }
+};
+
+// Global A/B feed instance
+static std::unique_ptr<ABFeed> g_ab_feed;
+
+// Start the replay source and the line handler; merged orders go into out.
+bool init_ab_feed(OrderRingBuffer& out, std::function<Order()> next_order, double loss_a, double loss_b, int interval_us) {
+    auto feed = std::make_unique<ABFeed>(&out, std::move(next_order), loss_a, loss_b, interval_us);
+    if (!feed->start()) {
+        LOG_ERROR("A/B feed: cannot bind line ports {}/{}", FEED_A_PORT, FEED_B_PORT);
+        return false;
+    }
+    g_ab_feed = std::move(feed);
+    return true;
+}
+
+void stop_ab_feed() {
+    if (g_ab_feed) g_ab_feed->stop();
+}
+
+FeedStats get_ab_feed_stats() {
+    if (!g_ab_feed) return {};
+    return g_ab_feed->get_stats();
+}
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+#include <time.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "wire.hpp"
+#include "latency_histogram.hpp"
+#include "network_stats.hpp"
+
+// Socket helpers and round-trip bookkeeping shared by the loopback transports
+// (client side) and the venue emulator (server side).
+
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
+// How a socket reader waits for data.
+//   BLOCKING:  recv blocks (up to the socket's receive timeout) and the kernel wakes the thread.
+//   BUSY_POLL: recv with MSG_DONTWAIT in a tight loop; SO_BUSY_POLL/SO_PREFER_BUSY_POLL are
+//              requested so the kernel also polls the device queue where the driver supports it.
+//   ADAPTIVE:  spins like BUSY_POLL, then parks in epoll_wait after spin_us without data.
+enum class RecvMode : uint8_t { BLOCKING, BUSY_POLL, ADAPTIVE };
+
+inline const char* recv_mode_name(RecvMode m) {
+    switch (m) {
+        case RecvMode::BLOCKING: return "blocking";
+        case RecvMode::BUSY_POLL: return "busy-poll";
+        case RecvMode::ADAPTIVE: return "adaptive";
+    }
+    return "?";
+}
+
+// Options for the real-socket client transports.
+struct LoopbackOptions {
+    std::string capture_path;       // pcap of every frame sent and received ("" = off)
+    bool kernel_timestamps = true;  // SO_TIMESTAMPING stack latency breakdown
+    RecvMode recv_mode = RecvMode::BLOCKING;
+    uint32_t spin_us = 200;         // ADAPTIVE: idle spin before parking
+};
+
+inline sockaddr_in loopback_addr(uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+inline uint16_t local_port(int fd) {
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) return 0;
+    return ntohs(addr.sin_port);
+}
+
+// Wakes blocking reads periodically so loops can observe their running flag.
+inline void set_recv_timeout(int fd, int timeout_ms) {
+    timeval tv{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+inline bool write_full(int fd, const char* data, size_t len) {
+    while (len) {
+        ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Kernel software stamps are CLOCK_REALTIME, so app times compared with them are too.
+inline uint64_t realtime_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Software stamp carried in a message's SCM_TIMESTAMPING cmsg, or 0.
+inline uint64_t cmsg_software_ns(msghdr& msg) {
+    for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_TIMESTAMPING) continue;
+        scm_timestamping ts;
+        std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+        return static_cast<uint64_t>(ts.ts[0].tv_sec) * 1000000000 + static_cast<uint64_t>(ts.ts[0].tv_nsec);
+    }
+    return 0;
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// CPU time a running thread has used so far; readable from any thread.
+inline uint64_t thread_cpu_ns(pthread_t t) {
+    clockid_t cid;
+    timespec ts;
+    if (pthread_getcpuclockid(t, &cid) != 0 || clock_gettime(cid, &ts) != 0) return 0;
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Receive wait strategy of one reader thread on one socket (see RecvMode). The reader
+// passes recv_flags() to each read and reports whether it got data.
+class SocketWaiter {
+    int epfd_ = -1;
+    RecvMode mode_ = RecvMode::BLOCKING;
+    uint64_t spin_ns_ = 0;
+    uint64_t idle_since_ = 0;
+    bool kernel_busy_poll_ = false;
+    std::atomic<uint64_t> empty_polls_{0}, parks_{0};
+public:
+    SocketWaiter() = default;
+    SocketWaiter(const SocketWaiter&) = delete;
+    SocketWaiter& operator=(const SocketWaiter&) = delete;
+    ~SocketWaiter() { if (epfd_ >= 0) close(epfd_); }
+
+    // Before the reader starts. Falls back to spinning without parking if epoll is unavailable.
+    void setup(int fd, RecvMode mode, uint32_t spin_us) {
+        mode_ = mode;
+        spin_ns_ = static_cast<uint64_t>(spin_us) * 1000;
+        if (mode == RecvMode::BLOCKING) return;
+        int busy_us = 50, one = 1;
+        kernel_busy_poll_ = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_us, sizeof(busy_us)) == 0;
+        if (kernel_busy_poll_) setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &one, sizeof(one));
+        if (mode == RecvMode::ADAPTIVE) {
+            epfd_ = epoll_create1(0);
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            if (epfd_ >= 0 && epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+                close(epfd_);
+                epfd_ = -1;
+            }
+        }
+    }
+    int recv_flags() const { return mode_ == RecvMode::BLOCKING ? 0 : MSG_DONTWAIT; }
+
+    void on_data() { idle_since_ = 0; }
+    // A read found nothing (or, when blocking, timed out).
+    void on_empty() {
+        if (mode_ == RecvMode::BLOCKING) return;
+        empty_polls_.store(empty_polls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (mode_ == RecvMode::ADAPTIVE && epfd_ >= 0) {
+            uint64_t now = wire_now_ns();
+            if (!idle_since_) idle_since_ = now;
+            else if (now - idle_since_ >= spin_ns_) {
+                parks_.store(parks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                epoll_event ev;
+                epoll_wait(epfd_, &ev, 1, 100);  // readable, or 100ms to recheck the running flag
+                idle_since_ = 0;
+                return;
+            }
+        }
+        cpu_relax();
+    }
+
+    // Filled in from any thread; cpu_pct needs the reader's CPU time and run time.
+    RecvWaitStats get_stats(uint64_t reader_cpu_ns, uint64_t wall_ns) const {
+        RecvWaitStats s;
+        s.mode = recv_mode_name(mode_);
+        s.kernel_busy_poll = kernel_busy_poll_;
+        s.empty_polls = empty_polls_.load(std::memory_order_relaxed);
+        s.parks = parks_.load(std::memory_order_relaxed);
+        s.cpu_pct = wall_ns ? 100.0 * reader_cpu_ns / wall_ns : 0.0;
+        return s;
+    }
+};
+
+// recv() that also returns the kernel RX stamp of the data (0 when the socket has none).
+inline ssize_t recv_stamped(int fd, char* data, size_t len, uint64_t& rx_ns, int flags = 0) {
+    iovec iov{data, len};
+    alignas(cmsghdr) char control[256];
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t n = ::recvmsg(fd, &msg, flags);
+    rx_ns = n > 0 ? cmsg_software_ns(msg) : 0;
+    return n;
+}
+
+// With rx_ns set, the RX stamp of the first chunk read is stored there; with wait set,
+// reads follow its receive mode.
+inline bool read_full(int fd, char* data, size_t len, const std::atomic<bool>& running, uint64_t* rx_ns = nullptr,
+                      SocketWaiter* wait = nullptr) {
+    int flags = wait ? wait->recv_flags() : 0;
+    while (len) {
+        uint64_t ts = 0;
+        ssize_t n = rx_ns ? recv_stamped(fd, data, len, ts, flags) : ::recv(fd, data, len, flags);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!running.load(std::memory_order_relaxed)) return false;
+            if (wait) wait->on_empty();
+            continue;
+        }
+        if (n <= 0) return false;
+        if (wait) wait->on_data();
+        if (rx_ns && !*rx_ns) *rx_ns = ts;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Reads one length-delimited wire frame from a stream socket into buf, and with rx_ns
+// set the RX stamp of its first bytes.
+template <typename T>
+bool read_frame(int fd, std::vector<char>& buf, const std::atomic<bool>& running, uint64_t* rx_ns = nullptr,
+                SocketWaiter* wait = nullptr) {
+    if (rx_ns) *rx_ns = 0;
+    buf.resize(sizeof(WireHeader));
+    if (!read_full(fd, buf.data(), sizeof(WireHeader), running, rx_ns, wait)) return false;
+    WireHeader hdr;
+    std::memcpy(&hdr, buf.data(), sizeof(hdr));
+    size_t len = frame_length<T>(hdr);
+    if (len == 0) return false;
+    buf.resize(len);
+    return read_full(fd, buf.data() + sizeof(WireHeader), len - sizeof(WireHeader), running, nullptr, wait);
+}
+
+// SO_TIMESTAMPING bookkeeping for one client socket. The sender registers each frame
+// before sending it; the kernel's TX software stamps come back on the socket's error
+// queue tagged with an OPT_ID key (per send for UDP, last byte offset for TCP), which
+// the reader drains before handling each reply so the reply can be matched by seq.
+class SocketTimestamper {
+    struct Pending { uint32_t key; uint64_t seq; uint64_t app_ns; };
+    struct Sent { uint64_t seq = 0; uint64_t tx_ns = 0; };
+    static constexpr size_t SLOTS = 4096;
+    std::mutex mutex_;
+    bool stream_ = false;
+    uint32_t next_key_ = 0;
+    std::deque<Pending> pending_;                     // awaiting a TX stamp, in key order
+    std::vector<Sent> sent_ = std::vector<Sent>(SLOTS); // TX stamp by seq % SLOTS
+    uint64_t tx_stamps_ = 0, rx_stamps_ = 0, unmatched_ = 0;
+    LatencyHistogram app_kernel_ns_, kernel_kernel_ns_, kernel_app_ns_;
+
+    void on_tx_stamp(uint32_t key, uint64_t tx_ns) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!pending_.empty() && static_cast<int32_t>(pending_.front().key - key) < 0) {
+            pending_.pop_front();
+            unmatched_++;
+        }
+        // A TCP frame split over several send() calls also stamps its earlier chunks
+        if (pending_.empty() || pending_.front().key != key) return;
+        Pending p = pending_.front();
+        pending_.pop_front();
+        tx_stamps_++;
+        app_kernel_ns_.record(tx_ns > p.app_ns ? tx_ns - p.app_ns : 0);
+        sent_[p.seq % SLOTS] = Sent{p.seq, tx_ns};
+    }
+public:
+    // Call once the socket is connected and before anything is sent on it.
+    bool enable(int fd, bool stream) {
+        stream_ = stream;
+        int flags = SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                    SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+        return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+    }
+
+    // Sender, under its send lock: frame seq of len bytes is about to go out at app_ns.
+    void on_send(uint64_t seq, uint64_t app_ns, size_t len) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t n = stream_ ? static_cast<uint32_t>(len) : 1;
+        pending_.push_back(Pending{next_key_ + n - 1, seq, app_ns});
+        next_key_ += n;
+        if (pending_.size() > SLOTS) {
+            pending_.pop_front();
+            unmatched_++;
+        }
+    }
+    // Sender: the send just registered failed, so the kernel assigned it no key.
+    void on_send_failed(size_t len) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.empty()) return;
+        pending_.pop_back();
+        next_key_ -= stream_ ? static_cast<uint32_t>(len) : 1;
+    }
+
+    // Reader: collects every TX stamp waiting on the error queue.
+    void drain_tx(int fd) {
+        alignas(cmsghdr) char control[256];
+        for (;;) {
+            msghdr msg{};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (::recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) return;
+            uint64_t tx_ns = cmsg_software_ns(msg);
+            for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+                if (c->cmsg_level != SOL_IP || c->cmsg_type != IP_RECVERR) continue;
+                sock_extended_err err;
+                std::memcpy(&err, CMSG_DATA(c), sizeof(err));
+                if (tx_ns && err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING && err.ee_info == SCM_TSTAMP_SND)
+                    on_tx_stamp(err.ee_data, tx_ns);
+            }
+        }
+    }
+    // Reader: the reply to frame seq was stamped rx_ns by the kernel and read at app_ns.
+    void on_reply(uint64_t seq, uint64_t rx_ns, uint64_t app_ns) {
+        if (!rx_ns) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        rx_stamps_++;
+        kernel_app_ns_.record(app_ns > rx_ns ? app_ns - rx_ns : 0);
+        const Sent& s = sent_[seq % SLOTS];
+        if (s.seq == seq) kernel_kernel_ns_.record(rx_ns > s.tx_ns ? rx_ns - s.tx_ns : 0);
+        else unmatched_++;
+    }
+
+    StackLatencyStats get_stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        StackLatencyStats s;
+        s.tx_stamps = tx_stamps_;
+        s.rx_stamps = rx_stamps_;
+        s.unmatched = unmatched_;
+        s.p50_app_kernel_ns = app_kernel_ns_.percentile(50);
+        s.p99_app_kernel_ns = app_kernel_ns_.percentile(99);
+        s.p50_kernel_kernel_ns = kernel_kernel_ns_.percentile(50);
+        s.p99_kernel_kernel_ns = kernel_kernel_ns_.percentile(99);
+        s.p50_kernel_app_ns = kernel_app_ns_.percentile(50);
+        s.p99_kernel_app_ns = kernel_app_ns_.percentile(99);
+        return s;
+    }
+};
+
+// Optional hook that also hands every exec report received by a loopback client to the
+// client's own return path. It is called on the transport's reader thread, so it must not block.
+using ExecSink = void (*)(const ExecReport&);
+inline std::atomic<ExecSink>& exec_sink() {
+    static std::atomic<ExecSink> sink{nullptr};
+    return sink;
+}
+
+// Collects exec reports on the client's reader thread; stats are read from main.
+class AckTracker {
+    mutable std::mutex mutex_;
+    std::atomic<uint64_t> batches_sent_{0};
+    std::atomic<uint64_t> send_failures_{0};
+    uint64_t batches_acked_ = 0;
+    uint64_t acks_ = 0;
+    uint64_t fills_ = 0;
+    uint64_t rejects_ = 0;
+    uint64_t cancels_ = 0;
+    uint64_t triggers_ = 0;
+    LatencyHistogram rtt_ns_;
+public:
+    void on_sent(bool ok) { (ok ? batches_sent_ : send_failures_).fetch_add(1, std::memory_order_relaxed); }
+    void on_exec_frame(const WireHeader& hdr, const std::vector<ExecReport>& reports) {
+        uint64_t rtt = wire_now_ns() - hdr.send_ts_ns;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batches_acked_++;
+            rtt_ns_.record(rtt);
+            for (const auto& r : reports) {
+                if (r.type == ExecType::ACK) acks_++;
+                else if (r.type == ExecType::FILL) fills_++;
+                else if (r.type == ExecType::CANCEL) cancels_++;
+                else if (r.type == ExecType::TRIGGERED) triggers_++;
+                else rejects_++;
+            }
+        }
+        if (ExecSink sink = exec_sink().load(std::memory_order_acquire))
+            for (const auto& r : reports) sink(r);
+    }
+    // Gives in-flight batches a short grace period before stats are sampled.
+    void wait_drained(std::chrono::milliseconds timeout) const {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < deadline) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (batches_acked_ >= batches_sent_.load(std::memory_order_relaxed)) return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    LoopbackStats get_stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        LoopbackStats s;
+        s.batches_sent = batches_sent_.load(std::memory_order_relaxed);
+        s.send_failures = send_failures_.load(std::memory_order_relaxed);
+        s.batches_acked = batches_acked_;
+        s.acks = acks_;
+        s.fills = fills_;
+        s.rejects = rejects_;
+        s.cancels = cancels_;
+        s.triggers = triggers_;
+        s.avg_rtt_us = rtt_ns_.mean() / 1000.0;
+        s.p50_rtt_ns = rtt_ns_.percentile(50);
+        s.p99_rtt_ns = rtt_ns_.percentile(99);
+        s.max_rtt_ns = rtt_ns_.max();
+        return s;
+    }
+};
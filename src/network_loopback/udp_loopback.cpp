@@ -0,0 +1,145 @@
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "order.hpp"
+#include "loopback_common.hpp"
+#include "async_logger.hpp"
+#include "pcap_capture.hpp"
+
+class UDPLoopbackClient {
+private:
+    int fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread reader_;
+    std::mutex send_mutex_;
+    std::vector<char> send_buf_;
+    uint64_t next_seq_ = 1;
+    AckTracker acks_;
+    uint16_t venue_port_ = 0;
+    uint16_t local_port_ = 0;
+    std::unique_ptr<PcapWriter> capture_;   // set before the reader starts
+    std::unique_ptr<SocketTimestamper> stamps_;
+    SocketWaiter wait_;
+    std::chrono::steady_clock::time_point started_;
+    pthread_t reader_handle_{};
+public:
+    ~UDPLoopbackClient() {
+        running_ = false;
+        if (reader_.joinable()) reader_.join();
+        if (fd_ >= 0) close(fd_);
+    }
+    // Records every order frame sent and exec frame received; call before connect_to().
+    bool capture_to(const std::string& path) {
+        capture_ = std::make_unique<PcapWriter>();
+        return capture_->open(path);
+    }
+    bool connect_to(uint16_t port, const LoopbackOptions& opts) {
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) return false;
+        sockaddr_in addr = loopback_addr(port);
+        if (connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+        venue_port_ = port;
+        local_port_ = local_port(fd_);
+        if (opts.kernel_timestamps) {
+            stamps_ = std::make_unique<SocketTimestamper>();
+            if (!stamps_->enable(fd_, false)) {
+                LOG_WARN("UDP loopback: SO_TIMESTAMPING unavailable, no stack latency breakdown");
+                stamps_.reset();
+            }
+        }
+        set_recv_timeout(fd_, 100);
+        wait_.setup(fd_, opts.recv_mode, opts.spin_us);
+        running_ = true;
+        started_ = std::chrono::steady_clock::now();
+        reader_ = std::thread(&UDPLoopbackClient::read_loop, this);
+        reader_handle_ = reader_.native_handle();
+        return true;
+    }
+    // One datagram per batch; a lost datagram simply never gets acked.
+    // A batch larger than one frame goes out as several, each with its own seq.
+    bool send_batch(const std::vector<Order>& orders, uint64_t) {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        size_t done = 0;
+        do {
+            uint64_t seq = next_seq_++;
+            done += encode_frame(MsgType::ORDER_BATCH, seq, wire_now_ns(), orders.data() + done, orders.size() - done, send_buf_);
+            uint64_t ts = capture_ ? pcap_now_ns() : 0;
+            if (stamps_) stamps_->on_send(seq, realtime_ns(), send_buf_.size());
+            bool ok = ::send(fd_, send_buf_.data(), send_buf_.size(), 0) == static_cast<ssize_t>(send_buf_.size());
+            acks_.on_sent(ok);
+            if (!ok && stamps_) stamps_->on_send_failed(send_buf_.size());
+            if (!ok) return false;
+            if (capture_) capture_->write(ts, PCAP_PROTO_UDP, local_port_, venue_port_, send_buf_.data(), send_buf_.size());
+        } while (done < orders.size());
+        return true;
+    }
+    LoopbackStats get_stats() const {
+        acks_.wait_drained(std::chrono::milliseconds(200));
+        LoopbackStats s = acks_.get_stats();
+        if (capture_) {
+            PcapWriterStats c = capture_->stats();
+            s.captured_frames = c.frames;
+            s.capture_dropped = c.dropped;
+        }
+        if (stamps_) s.stack = stamps_->get_stats();
+        auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started_).count();
+        s.recv = wait_.get_stats(thread_cpu_ns(reader_handle_), static_cast<uint64_t>(wall));
+        return s;
+    }
+private:
+    void read_loop() {
+        std::vector<char> buf(MAX_FRAME_BYTES);
+        std::vector<ExecReport> reports;
+        WireHeader hdr;
+        while (running_) {
+            uint64_t rx_ns = 0;
+            int flags = wait_.recv_flags();
+            ssize_t n = stamps_ ? recv_stamped(fd_, buf.data(), buf.size(), rx_ns, flags) : ::recv(fd_, buf.data(), buf.size(), flags);
+            if (n <= 0) {
+                wait_.on_empty();
+                continue;
+            }
+            wait_.on_data();
+            uint64_t app_ns = stamps_ ? realtime_ns() : 0;
+            if (capture_) capture_->write(pcap_now_ns(), PCAP_PROTO_UDP, venue_port_, local_port_, buf.data(), static_cast<size_t>(n));
+            if (decode_frame(buf.data(), static_cast<size_t>(n), MsgType::EXEC_BATCH, hdr, reports)) {
+                acks_.on_exec_frame(hdr, reports);
+                if (stamps_) {
+                    stamps_->drain_tx(fd_);
+                    stamps_->on_reply(hdr.seq, rx_ns, app_ns);
+                }
+            }
+        }
+    }
+};
+
+// Global UDP loopback client instance
+static std::unique_ptr<UDPLoopbackClient> g_udp_loopback;
+
+// Point a connected UDP socket at the venue emulator, with the capture, kernel
+// timestamp and receive mode options
+bool init_udp_loopback(uint16_t port, const LoopbackOptions& opts) {
+    auto client = std::make_unique<UDPLoopbackClient>();
+    if (!opts.capture_path.empty() && !client->capture_to(opts.capture_path)) {
+        LOG_ERROR("UDP loopback: cannot open capture file {}", opts.capture_path);
+        return false;
+    }
+    if (!client->connect_to(port, opts)) {
+        LOG_ERROR("UDP loopback: cannot open socket to venue on port {}", port);
+        return false;
+    }
+    g_udp_loopback = std::move(client);
+    return true;
+}
+
+bool udp_loopback_send_orders(const std::vector<Order>& orders, uint64_t batch_latency_us) {
+    if (!g_udp_loopback) return false;
+    return g_udp_loopback->send_batch(orders, batch_latency_us);
+}
+
+LoopbackStats get_udp_loopback_stats() {
+    if (!g_udp_loopback) return {};
+    return g_udp_loopback->get_stats();
+}
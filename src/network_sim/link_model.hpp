@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include "network_stats.hpp"
+
+enum class QueueDiscipline { DROP_TAIL, RED };
+
+// Per-packet header bytes; the Ethernet header sits outside the MTU.
+constexpr uint32_t ETH_HEADER_BYTES = 14;
+constexpr uint32_t IP_HEADER_BYTES = 20;
+constexpr uint32_t UDP_HEADER_BYTES = 8;
+constexpr uint32_t TCP_HEADER_BYTES = 20;
+
+// Bottleneck link shared by every batch a simulator sends.
+struct LinkConfig {
+    double bandwidth_mbps = 100.0;
+    uint32_t mtu_bytes = 1500;
+    uint32_t queue_limit_bytes = 64 * 1024;
+    QueueDiscipline discipline = QueueDiscipline::DROP_TAIL;
+    double red_min_fraction = 0.25;    // RED: start dropping at this share of the queue limit
+    double red_max_fraction = 0.75;    // ... and drop everything above this share
+    double red_max_p = 0.1;
+    double red_weight = 0.2;           // EWMA weight of the instantaneous queue
+};
+
+// UDP path behaviour past the bottleneck and the receiver's reorder buffer. A reordered
+// datagram is overtaken by 1..reorder_depth later ones; a duplicate copy arrives after
+// 0..reorder_depth later ones.
+struct UDPPathConfig {
+    double reorder_rate = 0.01;
+    uint32_t reorder_depth = 3;
+    double duplicate_rate = 0.005;
+    size_t reorder_window = 64;        // receiver slots, power of 2
+    uint64_t max_hold_us = 2000;       // receiver gives up a gap after this
+};
+
+// Serialization and queueing at a single bottleneck. The queue is kept as the time at
+// which the link finishes sending what is already queued; a packet's backlog in bytes
+// follows from that and the bandwidth, so no per-packet state is stored.
+class LinkModel {
+    LinkConfig cfg_;
+    uint32_t header_bytes_;   // Ethernet + IP + transport, per packet
+    double bytes_per_ns_;
+    uint64_t busy_until_ns_ = 0;
+    double avg_queue_bytes_ = 0.0;
+    std::mt19937 rng_{std::random_device{}()};
+    std::uniform_real_distribution<double> unit_{0.0, 1.0};
+    std::mutex mutex_;
+    LinkStats stats_;
+
+    static uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    bool admit(double backlog, uint64_t wire_bytes) {
+        if (backlog + wire_bytes > cfg_.queue_limit_bytes) { stats_.tail_drops++; return false; }
+        if (cfg_.discipline != QueueDiscipline::RED) return true;
+        avg_queue_bytes_ += cfg_.red_weight * (backlog - avg_queue_bytes_);
+        double min_th = cfg_.red_min_fraction * cfg_.queue_limit_bytes;
+        double max_th = cfg_.red_max_fraction * cfg_.queue_limit_bytes;
+        if (avg_queue_bytes_ < min_th) return true;
+        double p = avg_queue_bytes_ >= max_th ? 1.0 : cfg_.red_max_p * (avg_queue_bytes_ - min_th) / (max_th - min_th);
+        if (unit_(rng_) >= p) return true;
+        stats_.red_drops++;
+        return false;
+    }
+public:
+    LinkModel(const LinkConfig& cfg, uint32_t transport_header_bytes)
+        : cfg_(cfg), header_bytes_(ETH_HEADER_BYTES + IP_HEADER_BYTES + transport_header_bytes),
+          bytes_per_ns_(cfg.bandwidth_mbps / 8000.0) {
+        stats_.bandwidth_mbps = cfg.bandwidth_mbps;
+        stats_.mtu_bytes = cfg.mtu_bytes;
+    }
+
+    uint32_t packets_for(size_t payload_bytes) const {
+        uint32_t per_packet = cfg_.mtu_bytes - (header_bytes_ - ETH_HEADER_BYTES);
+        return static_cast<uint32_t>(std::max<size_t>(1, (payload_bytes + per_packet - 1) / per_packet));
+    }
+
+    // Queues payload_bytes (split into MTU-sized packets) behind whatever is already on
+    // the link at time now. Returns false on a queue drop; otherwise delay_ns is queueing
+    // plus serialization until the last packet is on the wire.
+    bool transmit_at(uint64_t now, size_t payload_bytes, uint64_t& delay_ns, uint32_t& packets) {
+        packets = packets_for(payload_bytes);
+        uint64_t wire_bytes = payload_bytes + static_cast<uint64_t>(packets) * header_bytes_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t start = std::max(now, busy_until_ns_);
+        double backlog = (start - now) * bytes_per_ns_;
+        stats_.batches++;
+        if (!admit(backlog, wire_bytes)) return false;
+        uint64_t serialization = static_cast<uint64_t>(wire_bytes / bytes_per_ns_);
+        busy_until_ns_ = start + serialization;
+        delay_ns = busy_until_ns_ - now;
+        stats_.packets += packets;
+        stats_.payload_bytes += payload_bytes;
+        stats_.wire_bytes += wire_bytes;
+        stats_.serialization_ns += serialization;
+        stats_.queueing_ns += start - now;
+        stats_.max_queue_bytes = std::max<uint64_t>(stats_.max_queue_bytes, static_cast<uint64_t>(backlog) + wire_bytes);
+        return true;
+    }
+    bool transmit(size_t payload_bytes, uint64_t& delay_ns, uint32_t& packets) {
+        return transmit_at(now_ns(), payload_bytes, delay_ns, packets);
+    }
+
+    LinkStats get_stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+};
@@ -4,6 +4,7 @@
 #include <thread>
 #include <vector>
 #include "network_stats.hpp"
+#include "async_logger.hpp"
 
 // Forward declaration
 struct Order;
@@ -38,14 +39,13 @@ static std::unique_ptr<SHMSimulator> g_shm_sim;
 // Initialize SHM simulator
 void init_shm_simulator(bool enable_noise, int noise_range_ns) {
     g_shm_sim = std::make_unique<SHMSimulator>(enable_noise, noise_range_ns);
-    std::cout << "SHM Simulator initialized: noise=" << (enable_noise ? "enabled" : "disabled") 
-              << ", noise_range=" << noise_range_ns << "ns\n";
+    LOG_INFO("SHM Simulator initialized: noise={}, noise_range={}ns", enable_noise ? "enabled" : "disabled", noise_range_ns);
 }
 
 // Send orders via SHM simulation
 bool shm_send_orders(const std::vector<Order>& orders, uint64_t batch_latency_us) {
     if (!g_shm_sim) {
-        std::cerr << "SHM Simulator not initialized\n";
+        LOG_ERROR("SHM Simulator not initialized");
         return false;
     }
     
@@ -4,9 +4,8 @@
 #include <thread>
 #include <vector>
 #include "network_stats.hpp"
-
-// Forward declaration
-struct Order;
+#include "wire.hpp"
+#include "link_model.hpp"
 
 class TCPSimulator {
 private:
@@ -18,25 +17,33 @@ private:
     int max_retries_;
     int dropped_packets_ = 0;
     int retransmissions_ = 0;
+    LinkModel link_;
 public:
-    TCPSimulator(double drop_rate = 0.02, int base_delay_ms = 5, int max_retries = 3)
+    TCPSimulator(double drop_rate = 0.02, int base_delay_ms = 5, int max_retries = 3, const LinkConfig& link = {})
         : rng_(std::random_device{}()), drop_dist_(0.0, 1.0), delay_dist_(0.8, 1.2),
-          drop_rate_(drop_rate), base_delay_ms_(base_delay_ms), max_retries_(max_retries) {}
+          drop_rate_(drop_rate), base_delay_ms_(base_delay_ms), max_retries_(max_retries),
+          link_(link, TCP_HEADER_BYTES) {}
+    // drop_rate is per segment: a batch is retransmitted whole if any of its segments is
+    // lost or the bottleneck queue has no room for it.
     bool send_reliable(const std::vector<Order>& orders, uint64_t) {
-        (void)orders;
+        size_t bytes = sizeof(WireHeader) + orders.size() * sizeof(Order);
         int retries = 0;
         while (retries <= max_retries_) {
-            double delay = base_delay_ms_ * delay_dist_(rng_);
-            std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(delay)));
-            if (drop_dist_(rng_) >= drop_rate_) return true;
+            uint64_t link_ns = 0;
+            uint32_t segments = 1;
+            bool lost = !link_.transmit(bytes, link_ns, segments);
+            double delay_us = base_delay_ms_ * 1000.0 * delay_dist_(rng_) + link_ns / 1000.0;
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(delay_us)));
+            for (uint32_t s = 0; s < segments && !lost; ++s) lost = drop_dist_(rng_) < drop_rate_;
+            if (!lost) return true;
             dropped_packets_++;
             if (retries < max_retries_) retransmissions_++;
             retries++;
         }
         return false;
     }
-    TCPStats get_stats() const {
-        return {dropped_packets_, retransmissions_, base_delay_ms_, drop_rate_};
+    TCPStats get_stats() {
+        return {dropped_packets_, retransmissions_, base_delay_ms_, drop_rate_, link_.get_stats()};
     }
 };
 
@@ -44,8 +51,8 @@ public:
 static std::unique_ptr<TCPSimulator> g_tcp_sim;
 
 // Initialize TCP simulator
-void init_tcp_simulator(double drop_rate, int base_delay_ms, int max_retries, bool) {
-    g_tcp_sim = std::make_unique<TCPSimulator>(drop_rate, base_delay_ms, max_retries);
+void init_tcp_simulator(double drop_rate, int base_delay_ms, int max_retries, bool, const LinkConfig& link) {
+    g_tcp_sim = std::make_unique<TCPSimulator>(drop_rate, base_delay_ms, max_retries, link);
 }
 
 // Send orders via TCP simulation
@@ -1,12 +1,16 @@
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <chrono>
 #include <thread>
 #include <vector>
+#include <mutex>
+#include <atomic>
 #include "network_stats.hpp"
-
-// Forward declaration
-struct Order;
+#include "wire.hpp"
+#include "link_model.hpp"
+#include "reorder_buffer.hpp"
+#include "latency_histogram.hpp"
 
 class UDPSimulator {
 private:
@@ -20,24 +24,123 @@ private:
     bool enable_jitter_;
     int packets_sent_ = 0;
     int packets_dropped_ = 0;
+    LinkModel link_;
+
+    // Receiver side: datagrams carry a sequence number (dropped ones leave gaps) and
+    // pass through the path's reordering before reaching the reorder buffer.
+    struct Datagram {
+        uint64_t seq = 0;
+        uint64_t send_ns = 0;
+    };
+    struct InFlight {
+        Datagram d;
+        uint32_t overtakes; // later datagrams still to arrive before this one
+    };
+    UDPPathConfig path_;
+    std::atomic<uint64_t> next_seq_{0};
+    std::mutex rx_mutex_;
+    std::mt19937 rx_rng_{std::random_device{}()};
+    std::vector<InFlight> in_flight_;
+    ReorderBuffer<Datagram> reorder_;
+    LatencyHistogram hold_ns_, delivery_ns_;
+    uint64_t reordered_ = 0, duplicated_ = 0;
+
+    static uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    auto on_release(uint64_t now) {
+        return [this, now](const Datagram& r, uint64_t held_ns) {
+            if (held_ns) hold_ns_.record(held_ns);
+            delivery_ns_.record(now - r.send_ns);
+        };
+    }
+    void to_receiver(const Datagram& d, uint64_t now) { reorder_.push(d.seq, now, d, on_release(now)); }
+    void arrive(const Datagram& d) {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::uniform_int_distribution<uint32_t> depth(1, std::max(1u, path_.reorder_depth));
+        std::lock_guard<std::mutex> lock(rx_mutex_);
+        uint64_t now = now_ns();
+        bool held = unit(rx_rng_) < path_.reorder_rate;
+        if (!held) to_receiver(d, now);
+        // Anything this datagram was the last to overtake arrives right behind it
+        for (size_t i = 0; i < in_flight_.size();) {
+            if (--in_flight_[i].overtakes == 0) {
+                to_receiver(in_flight_[i].d, now);
+                in_flight_[i] = in_flight_.back();
+                in_flight_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        if (held) { reordered_++; in_flight_.push_back({d, depth(rx_rng_)}); }
+        if (unit(rx_rng_) < path_.duplicate_rate) {
+            duplicated_++;
+            uint32_t after = depth(rx_rng_) - 1;
+            if (after == 0) to_receiver(d, now);
+            else in_flight_.push_back({d, after});
+        }
+        reorder_.poll(now, on_release(now));
+    }
     
 public:
-    UDPSimulator(double drop_rate = 0.02, int base_delay_us = 1000, bool enable_jitter = true)
+    UDPSimulator(double drop_rate = 0.02, int base_delay_us = 1000, bool enable_jitter = true, const LinkConfig& link = {},
+                 const UDPPathConfig& path = {})
         : rng_(std::random_device{}()), drop_dist_(0.0, 1.0), delay_dist_(0.5, 1.5),
-          drop_rate_(drop_rate), base_delay_us_(base_delay_us), enable_jitter_(enable_jitter) {}
+          drop_rate_(drop_rate), base_delay_us_(base_delay_us), enable_jitter_(enable_jitter),
+          link_(link, UDP_HEADER_BYTES), path_(path), reorder_(path.reorder_window, path.max_hold_us * 1000) {}
     
-    // Simulate UDP-like fast but lossy transmission
+    // Simulate UDP-like fast but lossy transmission. drop_rate is per IP fragment, and a
+    // datagram is lost if any of its fragments is, so large batches lose more often.
     bool send_fast(const std::vector<Order>& orders, uint64_t) {
-        (void)orders;
+        size_t bytes = sizeof(WireHeader) + orders.size() * sizeof(Order);
+        Datagram d{++next_seq_, now_ns()};
         packets_sent_++;
-        if (drop_dist_(rng_) < drop_rate_) { packets_dropped_++; return false; }
-        int delay_us = base_delay_us_;
-        if (enable_jitter_) delay_us = static_cast<int>(base_delay_us_ * delay_dist_(rng_));
-        std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+        uint64_t link_ns = 0;
+        uint32_t fragments = 1;
+        bool lost = !link_.transmit(bytes, link_ns, fragments);
+        for (uint32_t f = 0; f < fragments && !lost; ++f) lost = drop_dist_(rng_) < drop_rate_;
+        if (lost) { packets_dropped_++; return false; }
+        double delay_us = base_delay_us_;
+        if (enable_jitter_) delay_us *= delay_dist_(rng_);
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(delay_us + link_ns / 1000.0)));
+        arrive(d);
         return true;
     }
-    UDPStats get_stats() const {
-        return {packets_sent_, packets_dropped_, base_delay_us_, drop_rate_};
+    // End of run: datagrams still overtaken arrive in the order they were due, and the
+    // reorder buffer gives up its remaining gaps, so everything in transit is counted.
+    void flush() {
+        std::lock_guard<std::mutex> lock(rx_mutex_);
+        uint64_t now = now_ns();
+        std::stable_sort(in_flight_.begin(), in_flight_.end(),
+                         [](const InFlight& a, const InFlight& b) { return a.overtakes < b.overtakes; });
+        for (const InFlight& f : in_flight_) to_receiver(f.d, now);
+        in_flight_.clear();
+        reorder_.flush(now, on_release(now));
+    }
+    UDPStats get_stats() {
+        UDPStats s{packets_sent_, packets_dropped_, base_delay_us_, drop_rate_, link_.get_stats(), {}};
+        std::lock_guard<std::mutex> lock(rx_mutex_);
+        const ReorderBufferStats& r = reorder_.stats();
+        ReorderStats& o = s.reorder;
+        o.window = path_.reorder_window;
+        o.max_hold_us = path_.max_hold_us;
+        o.reordered = reordered_;
+        o.duplicated = duplicated_;
+        o.delivered = r.delivered;
+        o.held = r.held;
+        o.duplicates = r.duplicates;
+        o.late = r.late;
+        o.lost = r.lost;
+        o.hold_timeouts = r.hold_timeouts;
+        o.window_overflows = r.window_overflows;
+        o.max_pending = r.max_pending;
+        o.max_displacement = r.max_displacement;
+        o.p50_hold_ns = hold_ns_.percentile(50);
+        o.p99_hold_ns = hold_ns_.percentile(99);
+        o.max_hold_ns = hold_ns_.max();
+        o.p50_delivery_ns = delivery_ns_.percentile(50);
+        o.p99_delivery_ns = delivery_ns_.percentile(99);
+        return s;
     }
 };
 
@@ -45,8 +148,9 @@ public:
 static std::unique_ptr<UDPSimulator> g_udp_sim;
 
 // Initialize UDP simulator
-void init_udp_simulator(double drop_rate, int base_delay_us, bool enable_jitter) {
-    g_udp_sim = std::make_unique<UDPSimulator>(drop_rate, base_delay_us, enable_jitter);
+void init_udp_simulator(double drop_rate, int base_delay_us, bool enable_jitter, const LinkConfig& link,
+                        const UDPPathConfig& path) {
+    g_udp_sim = std::make_unique<UDPSimulator>(drop_rate, base_delay_us, enable_jitter, link, path);
 }
 
 // Send orders via UDP simulation
@@ -55,6 +159,10 @@ bool udp_send_orders(const std::vector<Order>& orders, uint64_t batch_latency_us
     return g_udp_sim->send_fast(orders, batch_latency_us);
 }
 
+void flush_udp_receiver() {
+    if (g_udp_sim) g_udp_sim->flush();
+}
+
 UDPStats get_udp_stats() {
     if (!g_udp_sim) return {};
     return g_udp_sim->get_stats();
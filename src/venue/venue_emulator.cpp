@@ -0,0 +1,351 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <random>
+#include <string>
+#include <atomic>
+#include <signal.h>
+#include <poll.h>
+#include <netinet/tcp.h>
+#include "matching_engine.hpp"
+#include "depth_publisher.hpp"
+#include "bar_aggregator.hpp"
+#include "position_keeper.hpp"
+#include "shm_channel.hpp"
+#include "src/network_loopback/loopback_common.hpp"
+#include "async_logger.hpp"
+
+// Stand-in exchange: listens on loopback TCP, UDP and SHM at once, matches
+// each inbound batch and answers with a frame of exec reports.
+
+struct VenueConfig {
+    uint16_t tcp_port = VENUE_TCP_PORT;
+    uint16_t udp_port = VENUE_UDP_PORT;
+    std::string shm_name = VENUE_SHM_NAME;
+    int runtime_seconds = 0; // 0 = until SIGINT/SIGTERM
+    int opening_auction_ms = 500; // call auction length, counted from the first order frame; 0 = none
+    uint64_t slow_subscriber_ns = 200000; // per-update handling cost of the slow depth subscriber
+    size_t max_accounts = 256;
+    std::string log_path = "venue_emulator.log"; // async diagnostics log
+    MatchingEngine::Config engine;
+};
+
+// Venue processing time per batch: fixed + per_order * n + uniform jitter,
+// burned as a busy-wait so acks reflect a venue that is actually working.
+struct LatencyModel {
+    uint64_t fixed_ns = 5000;
+    uint64_t per_order_ns = 200;
+    uint64_t jitter_ns = 2000;
+    std::mt19937_64 rng{42};
+
+    void apply(size_t orders) {
+        uint64_t delay = fixed_ns + per_order_ns * orders + (jitter_ns ? rng() % jitter_ns : 0);
+        uint64_t deadline = wire_now_ns() + delay;
+        while (wire_now_ns() < deadline) {}
+    }
+};
+
+std::atomic<bool> running{true};
+void signal_handler(int) { running = false; }
+
+class Venue {
+    PositionKeeper positions_;
+    MatchingEngine engine_;
+    DepthPublisher depth_;
+    BroadcastRing<TradePrint> tape_{1 << 16};
+    LatencyModel latency_;
+    std::mutex mutex_;
+    std::vector<ExecReport> pending_; // unsolicited or overflow reports, delivered first in the next reply
+    std::atomic<uint64_t> frames_in_{0};
+    std::atomic<uint64_t> bad_frames_{0};
+    std::atomic<uint64_t> first_frame_ns_{0};
+public:
+    explicit Venue(const VenueConfig& cfg)
+        : positions_(cfg.max_accounts, cfg.engine.max_symbols), engine_(cfg.engine), depth_(cfg.engine) {
+        engine_.set_position_keeper(&positions_);
+    }
+
+    // Decodes an order frame and encodes the matching exec frame into reply.
+    bool handle(const char* data, size_t len, std::vector<char>& reply) {
+        thread_local std::vector<Order> orders;
+        thread_local std::vector<ExecReport> reports;
+        WireHeader hdr;
+        if (!decode_frame(data, len, MsgType::ORDER_BATCH, hdr, orders)) { bad_frames_++; return false; }
+        if (frames_in_++ == 0) first_frame_ns_ = wire_now_ns();
+        std::lock_guard<std::mutex> lock(mutex_);
+        reports.swap(pending_);   // earlier reports go first
+        engine_.process(orders.data(), orders.size(), reports);
+        depth_.publish(engine_);
+        engine_.drain_trades([&](const TradePrint& t) { tape_.publish(t); });
+        latency_.apply(orders.size());
+        // What does not fit one frame waits, in order, for the next reply.
+        size_t sent = encode_frame(MsgType::EXEC_BATCH, hdr.seq, hdr.send_ts_ns, reports.data(), reports.size(), reply);
+        pending_.assign(reports.begin() + sent, reports.end());
+        return true;
+    }
+
+    uint64_t first_frame_ns() const { return first_frame_ns_.load(); }
+    const DepthPublisher& depth() const { return depth_; }
+    const BroadcastRing<TradePrint>& tape() const { return tape_; }
+    PositionKeeper& positions() { return positions_; }
+    std::string symbol_name(uint32_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return id < engine_.symbols().size() ? engine_.symbols().name(id) : std::string("?");
+    }
+
+    // Opening uncross: every symbol still in its call auction executes and goes continuous.
+    void open_market() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        engine_.uncross_all(pending_);
+        depth_.publish(engine_);
+        engine_.drain_trades([&](const TradePrint& t) { tape_.publish(t); });
+    }
+
+    void print_stats() {
+        static const char* tif_names[TIF_COUNT] = {"DAY", "GTC", "IOC", "FOK"};
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<ExecReport> expired;
+        engine_.end_of_day(expired);
+        const EngineStats& s = engine_.stats();
+        std::cout << "\n=== Venue Statistics ===\n";
+        std::cout << "Frames received: " << frames_in_ << "\n";
+        std::cout << "Bad frames: " << bad_frames_ << "\n";
+        std::cout << "Orders: " << s.orders << "\n";
+        std::cout << "Fills: " << s.fills << " (" << s.filled_qty << " shares)\n";
+        std::cout << "Rejects: " << s.rejects << "\n";
+        std::cout << "Cancelled (IOC/FOK/market remainder): " << s.cancelled << "\n";
+        std::cout << "DAY orders expired at close: " << s.expired << "\n";
+        std::cout << "Self-trades prevented: " << s.self_trades_prevented << "\n";
+        std::cout << "Risk rejects (gross exposure limit): " << s.risk_rejects << "\n";
+        std::cout << "Stops armed/triggered: " << s.stops_armed << "/" << s.stops_triggered
+                  << " (largest cascade " << s.max_cascade << ", fire p50 " << s.trigger_ns.percentile(50)
+                  << "ns, p99 " << s.trigger_ns.percentile(99) << "ns)\n";
+        std::cout << "Auctions uncrossed: " << s.auctions << " (" << s.auction_volume << " shares, uncross p50 "
+                  << s.uncross_ns.percentile(50) << "ns, max " << s.uncross_ns.max() << "ns)\n";
+        std::cout << "Symbols: " << engine_.symbols().size() << "\n";
+        for (size_t i = 0; i < TIF_COUNT; ++i) {
+            const LatencyHistogram& h = s.match_ns_by_tif[i];
+            std::cout << "Match latency " << tif_names[i] << " (" << s.orders_by_tif[i] << " orders): avg "
+                      << std::fixed << std::setprecision(1) << h.mean() << "ns, p50 " << h.percentile(50)
+                      << "ns, p99 " << h.percentile(99) << "ns, max " << h.max() << "ns\n";
+        }
+        const DepthPublisherStats& d = depth_.stats();
+        std::cout << "Depth updates published: " << d.updates << " in " << d.batches << " batches (publish p50 "
+                  << d.publish_ns.percentile(50) << "ns, p99 " << d.publish_ns.percentile(99) << "ns, max "
+                  << d.publish_ns.max() << "ns)\n";
+        std::cout << "==============================\n";
+    }
+};
+
+// Market-data consumer thread; delay_ns is burned per delivered update to model a slow client.
+void run_depth_subscriber(const DepthPublisher& depth, uint64_t delay_ns, DepthSubscriberStats& out) {
+    DepthSubscriber sub(depth);
+    while (running) {
+        size_t n = sub.poll([&](const LevelUpdate&) {
+            uint64_t deadline = wire_now_ns() + delay_ns;
+            while (delay_ns && wire_now_ns() < deadline) {}
+        });
+        if (n == 0) std::this_thread::yield();
+    }
+    out = sub.stats();
+}
+
+void print_subscriber_stats(const char* name, const DepthSubscriberStats& s) {
+    std::cout << "Depth subscriber " << name << ": received " << s.received << ", delivered " << s.delivered
+              << ", conflation " << std::fixed << std::setprecision(2) << s.conflation_ratio()
+              << "x (" << s.conflated_polls << " conflated polls), snapshot resyncs " << s.snapshots << "\n";
+}
+
+// Bar/VWAP consumer of the trade tape; reports per-print fold cost and the last closed bars.
+struct BarReport {
+    BarAggregatorStats stats;
+    LatencyHistogram ns_per_print;
+    std::vector<std::pair<uint32_t, Bar>> last_1s;
+    std::vector<std::pair<uint32_t, double>> session_vwap;
+};
+
+void run_bar_aggregator(const BroadcastRing<TradePrint>& tape, size_t max_symbols, BarReport& out) {
+    BarAggregator bars(tape, max_symbols, wire_now_ns());
+    std::vector<Bar> last(max_symbols);
+    auto on_close = [&](size_t interval, uint32_t symbol_id, const Bar& b) { if (interval == 0) last[symbol_id] = b; };
+    while (running) {
+        uint64_t start = wire_now_ns();
+        size_t n = bars.poll(start, on_close);
+        if (n) out.ns_per_print.record((wire_now_ns() - start) / n);
+        else std::this_thread::yield();
+    }
+    out.stats = bars.stats();
+    for (uint32_t s = 0; s < max_symbols; ++s) {
+        if (last[s].trades) out.last_1s.emplace_back(s, last[s]);
+        if (bars.session_volume(s)) out.session_vwap.emplace_back(s, bars.session_vwap(s));
+    }
+}
+
+void print_bar_report(Venue& venue, const BarReport& r) {
+    std::cout << "\n=== Bar Aggregator Statistics ===\n";
+    std::cout << "Trades aggregated: " << r.stats.trades << " (missed " << r.stats.missed << ")\n";
+    std::cout << "Bars closed: " << r.stats.bars_closed << " (" << r.stats.empty_closed << " empty intervals skipped)\n";
+    std::cout << "Fold cost per print: avg " << std::fixed << std::setprecision(1) << r.ns_per_print.mean()
+              << "ns, p99 " << r.ns_per_print.percentile(99) << "ns\n";
+    for (const auto& [id, b] : r.last_1s)
+        std::cout << "Last 1s bar " << venue.symbol_name(id) << ": O " << b.open / 100.0 << " H " << b.high / 100.0
+                  << " L " << b.low / 100.0 << " C " << b.close / 100.0 << " V " << b.volume
+                  << " VWAP " << std::setprecision(3) << b.vwap() / 100.0 << std::setprecision(1) << "\n";
+    for (const auto& [id, vwap] : r.session_vwap)
+        std::cout << "Session VWAP " << venue.symbol_name(id) << ": " << std::setprecision(3) << vwap / 100.0 << "\n";
+    std::cout << "==============================\n";
+}
+
+// Risk view: values every account from seqlock snapshots every 10ms, as a pre-trade
+// or monitoring client on another thread would, and tracks peak gross exposure.
+struct RiskReport {
+    uint64_t sweeps = 0;
+    LatencyHistogram ns_per_snapshot;
+    std::vector<int64_t> peak_gross;
+    std::vector<Exposure> last;
+};
+
+void run_risk_monitor(PositionKeeper& positions, RiskReport& out) {
+    out.peak_gross.assign(positions.max_accounts(), 0);
+    out.last.assign(positions.max_accounts(), Exposure{});
+    while (running) {
+        for (uint32_t a = 1; a < positions.max_accounts(); ++a) {
+            uint64_t start = wire_now_ns();
+            Exposure e = positions.exposure(a);
+            out.ns_per_snapshot.record(wire_now_ns() - start);
+            out.peak_gross[a] = std::max(out.peak_gross[a], e.gross_cents);
+            out.last[a] = e;
+        }
+        out.sweeps++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void print_risk_report(const PositionKeeper& positions, const RiskReport& r) {
+    const PositionKeeperStats& s = positions.stats();
+    std::cout << "\n=== Position Statistics ===\n";
+    std::cout << "Fills applied: " << s.fills << " (" << s.untracked << " untracked sides)\n";
+    std::cout << "Snapshots: " << s.snapshots << " in " << r.sweeps << " sweeps, retries " << s.snapshot_retries
+              << ", p50 " << r.ns_per_snapshot.percentile(50) << "ns, p99 " << r.ns_per_snapshot.percentile(99) << "ns\n";
+    for (size_t a = 1; a < r.last.size(); ++a) {
+        const Exposure& e = r.last[a];
+        if (!r.peak_gross[a]) continue;
+        std::cout << "Account " << a << ": gross $" << std::fixed << std::setprecision(0) << e.gross_cents / 100.0
+                  << " (peak $" << r.peak_gross[a] / 100.0 << "), net $" << e.net_cents / 100.0 << ", realized $"
+                  << e.realized_cents / 100.0 << ", unrealized $" << e.unrealized_cents / 100.0 << "\n";
+    }
+    std::cout << "==============================\n";
+}
+
+void serve_tcp(Venue& venue, uint16_t port) {
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = loopback_addr(port);
+    if (bind(lfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(lfd, 4) != 0) {
+        LOG_ERROR("Venue: TCP listen on port {} failed", port);
+        close(lfd);
+        return;
+    }
+    std::vector<char> frame, reply;
+    while (running) {
+        pollfd pfd{lfd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) continue;
+        int fd = accept(lfd, nullptr, nullptr);
+        if (fd < 0) continue;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        set_recv_timeout(fd, 100);
+        // One session at a time: the venue is a single sequencer per transport.
+        while (running && read_frame<Order>(fd, frame, running)) {
+            if (venue.handle(frame.data(), frame.size(), reply) && !write_full(fd, reply.data(), reply.size())) break;
+        }
+        close(fd);
+    }
+    close(lfd);
+}
+
+void serve_udp(Venue& venue, uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = loopback_addr(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        LOG_ERROR("Venue: UDP bind on port {} failed", port);
+        close(fd);
+        return;
+    }
+    set_recv_timeout(fd, 100);
+    std::vector<char> frame(MAX_FRAME_BYTES), reply;
+    while (running) {
+        sockaddr_in peer{};
+        socklen_t peer_len = sizeof(peer);
+        ssize_t n = recvfrom(fd, frame.data(), frame.size(), 0, reinterpret_cast<sockaddr*>(&peer), &peer_len);
+        if (n <= 0) continue;
+        if (venue.handle(frame.data(), static_cast<size_t>(n), reply))
+            sendto(fd, reply.data(), reply.size(), 0, reinterpret_cast<sockaddr*>(&peer), peer_len);
+    }
+    close(fd);
+}
+
+void serve_shm(Venue& venue, const std::string& name) {
+    ShmSegment segment;
+    if (!segment.create(name)) {
+        LOG_ERROR("Venue: cannot create SHM segment {}", name);
+        return;
+    }
+    ShmFrameRing& in = segment.layout()->to_venue;
+    ShmFrameRing& out = segment.layout()->to_client;
+    std::string frame;
+    std::vector<char> reply;
+    while (running) {
+        if (!in.try_read(frame)) { std::this_thread::yield(); continue; }
+        if (!venue.handle(frame.data(), frame.size(), reply)) continue;
+        while (running && !out.try_write(reply.data(), reply.size())) std::this_thread::yield();
+    }
+}
+
+int main() {
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    VenueConfig cfg;
+    cfg.engine.open_in_auction = cfg.opening_auction_ms > 0;
+    cfg.engine.trade_tape = true;
+    cfg.engine.max_gross_exposure_cents = 1000000000; // $10M per account at cost
+    AsyncLogger::instance().start(cfg.log_path.c_str());
+    Venue venue(cfg);
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(serve_tcp, std::ref(venue), cfg.tcp_port);
+    threads.emplace_back(serve_udp, std::ref(venue), cfg.udp_port);
+    threads.emplace_back(serve_shm, std::ref(venue), cfg.shm_name);
+    DepthSubscriberStats fast_md, slow_md;
+    threads.emplace_back(run_depth_subscriber, std::cref(venue.depth()), 0, std::ref(fast_md));
+    threads.emplace_back(run_depth_subscriber, std::cref(venue.depth()), cfg.slow_subscriber_ns, std::ref(slow_md));
+    BarReport bar_report;
+    RiskReport risk_report;
+    threads.emplace_back(run_risk_monitor, std::ref(venue.positions()), std::ref(risk_report));
+    threads.emplace_back(run_bar_aggregator, std::cref(venue.tape()), cfg.engine.max_symbols, std::ref(bar_report));
+    LOG_INFO("Venue emulator listening: tcp={} udp={} shm={}", cfg.tcp_port, cfg.udp_port, cfg.shm_name);
+    std::cout << "Venue emulator running (diagnostics in " << cfg.log_path << ")\n";
+
+    auto start = std::chrono::steady_clock::now();
+    bool open = !cfg.engine.open_in_auction;
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        uint64_t first = venue.first_frame_ns();
+        if (!open && first && wire_now_ns() - first >= static_cast<uint64_t>(cfg.opening_auction_ms) * 1000000) {
+            venue.open_market();
+            open = true;
+        }
+        if (cfg.runtime_seconds > 0 && std::chrono::steady_clock::now() - start >= std::chrono::seconds(cfg.runtime_seconds))
+            running = false;
+    }
+    for (auto& t : threads) t.join();
+    AsyncLogger::instance().stop();
+    venue.print_stats();
+    print_subscriber_stats("fast", fast_md);
+    print_subscriber_stats("slow", slow_md);
+    print_bar_report(venue, bar_report);
+    print_risk_report(venue.positions(), risk_report);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "order.hpp"
+
+// Armed stop and stop-limit orders for one symbol, bucketed by trigger price on
+// the same one-cent ladder as OrderBook. Buy stops fire when a trade prints at or
+// above their stop, sell stops at or below. Each side tracks its nearest armed
+// bucket, so a trade only ever visits buckets it actually crossed.
+class StopTriggerBook {
+    static constexpr uint32_t NIL = UINT32_MAX;
+    struct Node {
+        Order order;
+        uint32_t next;
+    };
+    struct Bucket {
+        uint32_t head = NIL;
+        uint32_t tail = NIL;
+    };
+    uint32_t min_price_;
+    int64_t num_levels_;
+    std::vector<Bucket> buy_;
+    std::vector<Bucket> sell_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_;
+    int64_t lowest_buy_;        // nearest armed buy stop, num_levels_ when none
+    int64_t highest_sell_ = -1; // nearest armed sell stop, -1 when none
+    size_t armed_buy_ = 0;
+    size_t armed_sell_ = 0;
+public:
+    StopTriggerBook(uint32_t min_price_cents, uint32_t max_price_cents, size_t max_armed)
+        : min_price_(min_price_cents), num_levels_(static_cast<int64_t>(max_price_cents) - min_price_cents + 1),
+          buy_(num_levels_), sell_(num_levels_), nodes_(max_armed), lowest_buy_(num_levels_) {
+        free_.reserve(max_armed);
+        for (size_t i = max_armed; i > 0; --i) free_.push_back(static_cast<uint32_t>(i - 1));
+    }
+
+    // Files o under its stop price; false when the price is off-ladder or the pool is full.
+    bool arm(const Order& o) {
+        int64_t idx = static_cast<int64_t>(o.stop_price_cents) - min_price_;
+        if (idx < 0 || idx >= num_levels_ || free_.empty()) return false;
+        uint32_t n = free_.back();
+        free_.pop_back();
+        nodes_[n] = Node{o, NIL};
+        bool buy = o.type == OrderType::BUY;
+        Bucket& b = buy ? buy_[idx] : sell_[idx];
+        if (b.tail != NIL) nodes_[b.tail].next = n; else b.head = n;
+        b.tail = n;
+        if (buy) { armed_buy_++; lowest_buy_ = std::min(lowest_buy_, idx); }
+        else { armed_sell_++; highest_sell_ = std::max(highest_sell_, idx); }
+        return true;
+    }
+
+    // A run of trades printed between low and high: fires every crossed bucket, in
+    // bucket order and FIFO within a bucket, passing each activated order to fire(Order&).
+    template <typename Fire>
+    size_t on_trade(uint32_t low_price_cents, uint32_t high_price_cents, Fire&& fire) {
+        size_t fired = 0;
+        int64_t high = static_cast<int64_t>(high_price_cents) - min_price_;
+        int64_t low = static_cast<int64_t>(low_price_cents) - min_price_;
+        while (armed_buy_ && lowest_buy_ <= high) {
+            fired += drain(buy_[lowest_buy_], armed_buy_, fire);
+            while (armed_buy_ && buy_[lowest_buy_].head == NIL) ++lowest_buy_;
+        }
+        if (!armed_buy_) lowest_buy_ = num_levels_;
+        while (armed_sell_ && highest_sell_ >= low) {
+            fired += drain(sell_[highest_sell_], armed_sell_, fire);
+            while (armed_sell_ && sell_[highest_sell_].head == NIL) --highest_sell_;
+        }
+        if (!armed_sell_) highest_sell_ = -1;
+        return fired;
+    }
+
+    // True when a trade at price would fire a stop armed now (already-crossed stops).
+    static bool crossed(const Order& o, uint32_t last_price_cents) {
+        if (last_price_cents == 0) return false;
+        return o.type == OrderType::BUY ? last_price_cents >= o.stop_price_cents : last_price_cents <= o.stop_price_cents;
+    }
+
+    size_t armed() const { return armed_buy_ + armed_sell_; }
+
+private:
+    template <typename Fire>
+    size_t drain(Bucket& b, size_t& armed, Fire& fire) {
+        size_t fired = 0;
+        uint32_t n = b.head;
+        b.head = b.tail = NIL;
+        while (n != NIL) {
+            uint32_t next = nodes_[n].next;
+            fire(nodes_[n].order);
+            free_.push_back(n);
+            armed--;
+            fired++;
+            n = next;
+        }
+        return fired;
+    }
+};
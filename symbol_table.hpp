@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "order.hpp"
+
+// Interns the fixed-width Order::symbol into dense ids so per-symbol state
+// (books, bars, positions) can live in flat arrays indexed by id.
+// Open addressing on the two 8-byte words of the symbol; single writer.
+class SymbolTable {
+    struct Slot {
+        uint64_t key[2];
+        uint32_t id;
+        bool used;
+    };
+    std::vector<Slot> slots_;
+    std::vector<std::string> names_;
+    size_t max_symbols_;
+
+    static void load_key(const char* sym, uint64_t key[2]) {
+        char padded[16] = {};
+        std::memcpy(padded, sym, strnlen(sym, sizeof(padded) - 1));
+        std::memcpy(key, padded, sizeof(padded));
+    }
+    size_t probe(const uint64_t key[2]) const {
+        uint64_t h = (key[0] ^ (key[1] * 0x9E3779B97F4A7C15ull)) * 0xFF51AFD7ED558CCDull;
+        size_t mask = slots_.size() - 1;
+        size_t i = static_cast<size_t>(h >> 32) & mask;
+        while (slots_[i].used && (slots_[i].key[0] != key[0] || slots_[i].key[1] != key[1])) i = (i + 1) & mask;
+        return i;
+    }
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    explicit SymbolTable(size_t max_symbols = 256) : max_symbols_(max_symbols) {
+        size_t cap = 1;
+        while (cap < max_symbols * 2) cap <<= 1;
+        slots_.assign(cap, Slot{{0, 0}, 0, false});
+    }
+    // Returns the symbol's id, assigning the next free one on first sight; INVALID when full.
+    uint32_t intern(const char* sym) {
+        uint64_t key[2];
+        load_key(sym, key);
+        size_t i = probe(key);
+        if (slots_[i].used) return slots_[i].id;
+        if (names_.size() >= max_symbols_) return INVALID;
+        slots_[i] = Slot{{key[0], key[1]}, static_cast<uint32_t>(names_.size()), true};
+        names_.emplace_back(sym, strnlen(sym, sizeof(Order::symbol)));
+        return slots_[i].id;
+    }
+    uint32_t find(const char* sym) const {
+        uint64_t key[2];
+        load_key(sym, key);
+        size_t i = probe(key);
+        return slots_[i].used ? slots_[i].id : INVALID;
+    }
+    const std::string& name(uint32_t id) const { return names_[id]; }
+    size_t size() const { return names_.size(); }
+    size_t capacity() const { return max_symbols_; }
+};
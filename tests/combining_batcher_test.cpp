@@ -0,0 +1,42 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "combining_batcher.hpp"
+#include "tests/test_util.hpp"
+
+// More threads than CombiningBatcher has slots: the ones without a slot take the
+// locked path, and every order still reaches a batch exactly once.
+static void test_more_threads_than_slots() {
+    const size_t threads = CombiningBatcher::MAX_THREADS + 8;
+    const uint64_t per_thread = 200;
+    std::vector<uint32_t> seen(threads * per_thread, 0);   // only the combiner writes
+    CombiningBatcher batcher(16, std::chrono::microseconds(1000000), [&](const std::vector<Order>& batch, uint64_t) {
+        for (const Order& o : batch) seen[o.order_id]++;
+    });
+    std::atomic<size_t> started{0};
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            Order o;
+            for (uint64_t i = 0; i < per_thread; ++i) {
+                o.order_id = t * per_thread + i;
+                batcher.add_order(o);
+                // After the first order every thread holds its index until all have one
+                if (i == 0) {
+                    started.fetch_add(1);
+                    while (started.load() < threads) std::this_thread::yield();
+                }
+            }
+        });
+    for (auto& t : pool) t.join();
+    batcher.force_flush();
+    bool once = true;
+    for (uint32_t n : seen) once = once && n == 1;
+    CHECK(once);
+    CHECK(batcher.stats().orders == threads * per_thread);
+}
+
+int main() {
+    test_more_threads_than_slots();
+    return test_result("combining_batcher_test");
+}
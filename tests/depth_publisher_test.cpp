@@ -0,0 +1,69 @@
+#include <vector>
+#include "depth_publisher.hpp"
+#include "tests/test_util.hpp"
+
+struct Seen {
+    uint64_t seq;
+    uint64_t qty;
+    uint32_t price_cents;
+    LevelAction action;
+};
+
+// Three batches change the same bid level before the subscriber polls once; then a
+// second symbol adds a level. A subscriber that keeps up must get every delta, in order.
+static void run_batches(MatchingEngine& engine, DepthPublisher& pub) {
+    std::vector<ExecReport> out;
+    Order batches[] = {
+        Order(1, "AAPL", OrderType::BUY, 100.00, 100),
+        Order(2, "AAPL", OrderType::BUY, 100.00, 50),
+        Order(3, "AAPL", OrderType::SELL, 100.00, 120, TimeInForce::IOC),
+        Order(4, "MSFT", OrderType::SELL, 101.00, 10),
+    };
+    for (const Order& o : batches) {
+        engine.process(&o, 1, out);
+        pub.publish(engine);
+    }
+}
+
+static void test_fast_subscriber_sees_every_delta() {
+    MatchingEngine::Config cfg;
+    MatchingEngine engine(cfg);
+    DepthPublisher pub(cfg, 64);
+    DepthSubscriber sub(pub);
+    run_batches(engine, pub);
+    std::vector<Seen> seen;
+    sub.poll([&](const LevelUpdate& u) { seen.push_back(Seen{u.seq, u.qty, u.price_cents, u.action}); });
+    CHECK(seen.size() == 4);
+    if (seen.size() != 4) return;
+    for (uint64_t i = 0; i < seen.size(); ++i) CHECK(seen[i].seq == i);
+    CHECK(seen[0].qty == 100 && seen[0].action == LevelAction::ADD);
+    CHECK(seen[1].qty == 150 && seen[1].action == LevelAction::UPDATE);
+    CHECK(seen[2].qty == 30 && seen[2].action == LevelAction::UPDATE);
+    CHECK(seen[3].qty == 10 && seen[3].price_cents == 10100 && seen[3].action == LevelAction::ADD);
+    CHECK(sub.stats().conflated_polls == 0);
+    CHECK(sub.stats().received == 4 && sub.stats().delivered == 4);
+}
+
+// The same stream, read by a subscriber that tolerates only one update of backlog: it
+// conflates, so the bid level arrives once with its final quantity, still before MSFT.
+static void test_lagging_subscriber_conflates() {
+    MatchingEngine::Config cfg;
+    MatchingEngine engine(cfg);
+    DepthPublisher pub(cfg, 64);
+    DepthSubscriber sub(pub, 1);
+    run_batches(engine, pub);
+    std::vector<Seen> seen;
+    sub.poll([&](const LevelUpdate& u) { seen.push_back(Seen{u.seq, u.qty, u.price_cents, u.action}); });
+    CHECK(seen.size() == 2);
+    if (seen.size() != 2) return;
+    CHECK(seen[0].price_cents == 10000 && seen[0].qty == 30 && seen[0].action == LevelAction::ADD);
+    CHECK(seen[1].price_cents == 10100 && seen[1].qty == 10);
+    CHECK(sub.stats().conflated_polls == 1);
+    CHECK(sub.stats().received == 4);
+}
+
+int main() {
+    test_fast_subscriber_sees_every_delta();
+    test_lagging_subscriber_conflates();
+    return test_result("depth_publisher_test");
+}
@@ -0,0 +1,24 @@
+#include "fair_ingress.hpp"
+#include "tests/test_util.hpp"
+
+// Untagged orders (client_id 0) and unknown clients have no queue: rejected and counted,
+// while a tagged order goes through.
+static void test_untagged_order_rejected() {
+    OrderRingBuffer ring(16);
+    FairIngress ingress(ring, 2, 8);
+    Order o;
+    CHECK(!ingress.try_push(o));
+    o.client_id = 3;
+    CHECK(!ingress.try_push(o));
+    CHECK(ingress.untagged() == 2);
+    o.client_id = 2;
+    CHECK(ingress.try_push(o));
+    CHECK(ingress.service() == 1);
+    CHECK(ingress.stats(2).forwarded == 1);
+    CHECK(ingress.stats(1).submitted == 0);
+}
+
+int main() {
+    test_untagged_order_rejected();
+    return test_result("fair_ingress_test");
+}
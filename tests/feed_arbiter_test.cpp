@@ -0,0 +1,47 @@
+#include <vector>
+#include "feed_arbiter.hpp"
+#include "tests/test_util.hpp"
+
+static Order seq_order(uint64_t seq) {
+    Order o;
+    o.order_id = seq;
+    return o;
+}
+
+// Both lines deliver everything in order: each message exactly once.
+static void test_no_loss() {
+    FeedArbiter arb(16);
+    std::vector<uint64_t> out;
+    auto emit = [&](const Order& o) { out.push_back(o.order_id); };
+    for (uint64_t seq = 1; seq <= 5; ++seq) {
+        arb.on_message(0, seq, seq_order(seq), emit);
+        arb.on_message(1, seq, seq_order(seq), emit);
+    }
+    CHECK((out == std::vector<uint64_t>{1, 2, 3, 4, 5}));
+    CHECK(arb.stats().duplicates == 5);
+    CHECK(arb.stats().lost == 0);
+}
+
+// Seq 3 is lost on both lines. Line A runs ahead and its 4 and 5 wait in the window;
+// line B's copy of 4, a duplicate, is what shows both lines have passed 3. That must
+// release 4 and 5 with no further traffic.
+static void test_gap_on_both_lines_released_by_duplicate() {
+    FeedArbiter arb(16);
+    std::vector<uint64_t> out;
+    auto emit = [&](const Order& o) { out.push_back(o.order_id); };
+    for (uint64_t seq : {1, 2, 4, 5}) arb.on_message(0, seq, seq_order(seq), emit);
+    CHECK((out == std::vector<uint64_t>{1, 2}));
+    CHECK(arb.pending() == 2);
+    for (uint64_t seq : {1, 2, 4}) arb.on_message(1, seq, seq_order(seq), emit);
+    CHECK((out == std::vector<uint64_t>{1, 2, 4, 5}));
+    CHECK(arb.pending() == 0);
+    CHECK(arb.next_expected() == 6);
+    CHECK(arb.stats().lost == 1);
+    CHECK(arb.stats().unrecoverable_gaps == 1);
+}
+
+int main() {
+    test_no_loss();
+    test_gap_on_both_lines_released_by_duplicate();
+    return test_result("feed_arbiter_test");
+}
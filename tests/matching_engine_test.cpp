@@ -0,0 +1,118 @@
+#include <vector>
+#include "matching_engine.hpp"
+#include "position_keeper.hpp"
+#include "tests/test_util.hpp"
+
+static Order limit(uint64_t id, OrderType side, double price, uint32_t qty) {
+    return Order(id, "AAPL", side, price, qty);
+}
+
+static size_t count(const std::vector<ExecReport>& out, uint64_t id, ExecType type) {
+    size_t n = 0;
+    for (const ExecReport& e : out) n += e.order_id == id && e.type == type;
+    return n;
+}
+
+static MatchingEngine::Config small_pool(size_t resting) {
+    MatchingEngine::Config cfg;
+    cfg.max_resting_per_symbol = resting;
+    return cfg;
+}
+
+// A full pool with no fill: REJECT alone, no ACK.
+static void test_full_pool_rejects_untouched_order() {
+    MatchingEngine engine(small_pool(1));
+    std::vector<ExecReport> out;
+    Order maker = limit(1, OrderType::SELL, 100.00, 50);
+    engine.process(&maker, 1, out);
+    out.clear();
+    Order o = limit(2, OrderType::BUY, 99.00, 10);
+    engine.process(&o, 1, out);
+    CHECK(out.size() == 1);
+    CHECK(count(out, 2, ExecType::REJECT) == 1);
+    CHECK(engine.stats().rejects == 1);
+}
+
+// The pool is full (two resting orders, two nodes) and the buy fills only 50 of its
+// 80. The filled maker frees its node, so the remainder still rests.
+static void test_full_pool_partial_fill_rests_remainder() {
+    MatchingEngine engine(small_pool(2));
+    std::vector<ExecReport> out;
+    Order makers[] = {limit(1, OrderType::SELL, 100.00, 50), limit(2, OrderType::BUY, 90.00, 10)};
+    engine.process(makers, 2, out);
+    out.clear();
+    Order o = limit(3, OrderType::BUY, 100.00, 80);
+    engine.process(&o, 1, out);
+    CHECK(count(out, 3, ExecType::FILL) == 1);
+    CHECK(count(out, 3, ExecType::REJECT) == 0);
+    CHECK(count(out, 3, ExecType::CANCEL) == 0);
+    CHECK(engine.book(0)->bid_qty_at(10000) == 30);
+}
+
+// The book cannot rest the remainder of a partly filled order (here its id is still
+// live at another price): the fill stands and the remainder is cancelled, not rejected.
+static void test_unrestable_remainder_after_fill_is_cancelled() {
+    MatchingEngine engine(small_pool(4));
+    std::vector<ExecReport> out;
+    Order makers[] = {limit(7, OrderType::BUY, 99.00, 10), limit(1, OrderType::SELL, 100.00, 50)};
+    engine.process(makers, 2, out);
+    out.clear();
+    Order o = limit(7, OrderType::BUY, 100.00, 80);
+    engine.process(&o, 1, out);
+    CHECK(count(out, 7, ExecType::ACK) == 1);
+    CHECK(count(out, 7, ExecType::FILL) == 1);
+    CHECK(count(out, 1, ExecType::FILL) == 1);
+    CHECK(count(out, 7, ExecType::REJECT) == 0);
+    CHECK(count(out, 7, ExecType::CANCEL) == 1);
+    CHECK(out.back().order_id == 7 && out.back().type == ExecType::CANCEL);
+    CHECK(engine.stats().cancelled == 1);
+    CHECK(engine.stats().rejects == 0);
+    CHECK(engine.stats().filled_qty == 50);
+    CHECK(engine.book(0)->bid_qty_at(9900) == 10);
+    CHECK(engine.book(0)->bid_qty_at(10000) == 0);
+}
+
+// With a $1000 gross exposure limit, orders without a limit price are valued at a real
+// reference: stops at their stop price, market orders at the far touch. A market order
+// with no touch and no last trade has nothing to be valued at and is rejected.
+static void test_exposure_prices_market_and_stop_orders() {
+    MatchingEngine::Config cfg;
+    cfg.max_gross_exposure_cents = 100000;
+    MatchingEngine engine(cfg);
+    PositionKeeper keeper(8, cfg.max_symbols);
+    engine.set_position_keeper(&keeper);
+    std::vector<ExecReport> out;
+
+    Order mkt(1, "AAPL", OrderType::BUY, 0.0, 5, TimeInForce::IOC, OrderKind::MARKET);
+    mkt.account_id = 2;
+    engine.process(&mkt, 1, out);
+    CHECK(count(out, 1, ExecType::REJECT) == 1);
+
+    Order stop(2, "AAPL", OrderType::BUY, 0.0, 10, TimeInForce::DAY, OrderKind::STOP);
+    stop.stop_price_cents = 20000;
+    stop.account_id = 2;
+    engine.process(&stop, 1, out);
+    CHECK(count(out, 2, ExecType::REJECT) == 1);
+    CHECK(engine.stats().risk_rejects == 2);
+
+    Order maker = limit(3, OrderType::SELL, 100.00, 10);
+    maker.account_id = 1;
+    engine.process(&maker, 1, out);
+    Order big(4, "AAPL", OrderType::BUY, 0.0, 20, TimeInForce::IOC, OrderKind::MARKET);
+    big.account_id = 2;
+    engine.process(&big, 1, out);
+    CHECK(count(out, 4, ExecType::REJECT) == 1);
+    Order small(5, "AAPL", OrderType::BUY, 0.0, 5, TimeInForce::IOC, OrderKind::MARKET);
+    small.account_id = 2;
+    engine.process(&small, 1, out);
+    CHECK(count(out, 5, ExecType::FILL) == 1);
+    CHECK(engine.stats().risk_rejects == 3);
+}
+
+int main() {
+    test_full_pool_rejects_untouched_order();
+    test_full_pool_partial_fill_rests_remainder();
+    test_unrestable_remainder_after_fill_is_cancelled();
+    test_exposure_prices_market_and_stop_orders();
+    return test_result("matching_engine_test");
+}
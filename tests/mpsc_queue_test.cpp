@@ -0,0 +1,66 @@
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+#include "mpsc_queue.hpp"
+#include "tests/test_util.hpp"
+
+struct Item : MpscNode {
+    uint32_t producer = 0;
+    uint32_t seq = 0;
+};
+
+// Several producers push numbered nodes from a pool smaller than the traffic, so nodes
+// are recycled while others are in flight. The consumer must see every node exactly
+// once and each producer's nodes in push order, and gets every node back to the pool.
+static void test_concurrent_pushers() {
+    constexpr uint32_t PRODUCERS = 4;
+    constexpr uint32_t PER_PRODUCER = 50000;
+    NodePool<Item> pool(256);
+    MpscQueue<Item> queue;
+    std::atomic<uint32_t> ready{0};
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&, p] {
+            ready++;
+            while (ready.load() < PRODUCERS) std::this_thread::yield();
+            for (uint32_t s = 0; s < PER_PRODUCER; ++s) {
+                Item* item;
+                while (!(item = pool.acquire())) std::this_thread::yield();
+                item->producer = p;
+                item->seq = s;
+                queue.push(item);
+            }
+        });
+    }
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    uint64_t received = 0, out_of_order = 0, bad_producer = 0;
+    while (received < uint64_t(PRODUCERS) * PER_PRODUCER) {
+        Item* item = queue.pop();
+        if (!item) { std::this_thread::yield(); continue; }
+        received++;
+        if (item->producer >= PRODUCERS) bad_producer++;
+        else if (item->seq != next[item->producer]++) out_of_order++;
+        pool.release(item);
+    }
+    for (auto& t : producers) t.join();
+    CHECK(bad_producer == 0);
+    CHECK(out_of_order == 0);
+    for (uint32_t p = 0; p < PRODUCERS; ++p) CHECK(next[p] == PER_PRODUCER);
+    CHECK(queue.pop() == nullptr);
+
+    // Every node came back: the whole capacity can be taken again, each node once.
+    std::set<Item*> taken;
+    for (size_t i = 0; i < pool.capacity(); ++i) {
+        Item* item = pool.acquire();
+        CHECK(item != nullptr);
+        taken.insert(item);
+    }
+    CHECK(taken.size() == pool.capacity());
+    CHECK(pool.acquire() == nullptr);
+}
+
+int main() {
+    test_concurrent_pushers();
+    return test_result("mpsc_queue_test");
+}
@@ -0,0 +1,100 @@
+#include <vector>
+#include "order_book.hpp"
+#include "tests/test_util.hpp"
+
+static Order limit(uint64_t id, OrderType side, double price, uint32_t qty, uint32_t account,
+                   TimeInForce tif = TimeInForce::DAY, StpMode stp = StpMode::NONE) {
+    Order o(id, "AAPL", side, price, qty, tif);
+    o.account_id = account;
+    o.stp = stp;
+    return o;
+}
+
+// Book with 50 from account 1 and then 50 from account 2 at 100.00, and 100 from
+// account 1 at 100.01.
+static void seed(OrderBook& book) {
+    auto no_fill = [](const Fill&) {};
+    book.add(limit(1, OrderType::SELL, 100.00, 50, 1), no_fill);
+    book.add(limit(2, OrderType::SELL, 100.00, 50, 2), no_fill);
+    book.add(limit(3, OrderType::SELL, 100.01, 100, 1), no_fill);
+}
+
+// A FOK from account 2 that can be filled only by counting its own resting quantity is
+// killed whole, leaving every maker in place, whatever the STP mode.
+static void test_fok_stp_ignores_own_liquidity() {
+    for (StpMode stp : {StpMode::CANCEL_NEWEST, StpMode::CANCEL_OLDEST, StpMode::DECREMENT}) {
+        OrderBook book(5000, 25000, 16);
+        seed(book);
+        std::vector<Fill> fills;
+        MatchResult r = book.add(limit(10, OrderType::BUY, 100.00, 100, 2, TimeInForce::FOK, stp),
+                                 [&](const Fill& f) { fills.push_back(f); });
+        CHECK(fills.empty());
+        CHECK(r.filled == 0);
+        CHECK(r.cancelled == 100);
+        CHECK(book.ask_qty_at(10000) == 100);
+        CHECK(book.resting() == 3);
+    }
+}
+
+// Own quantity ahead of and behind the only other-account maker. Whether STP would
+// remove it or stop there, 50 of the 150 can trade, so nothing is touched.
+static void test_fok_stp_own_liquidity_first() {
+    for (StpMode stp : {StpMode::CANCEL_NEWEST, StpMode::CANCEL_OLDEST, StpMode::DECREMENT}) {
+        OrderBook book(5000, 25000, 16);
+        seed(book);
+        std::vector<Fill> fills;
+        MatchResult r = book.add(limit(10, OrderType::BUY, 100.01, 150, 1, TimeInForce::FOK, stp),
+                                 [&](const Fill& f) { fills.push_back(f); });
+        CHECK(fills.empty());
+        CHECK(r.cancelled == 150);
+        CHECK(book.resting() == 3);
+    }
+    // Enough other-account quantity: CANCEL_OLDEST fills in full and removes the own maker.
+    OrderBook book(5000, 25000, 16);
+    seed(book);
+    std::vector<Fill> fills;
+    MatchResult r = book.add(limit(10, OrderType::BUY, 100.01, 50, 1, TimeInForce::FOK, StpMode::CANCEL_OLDEST),
+                             [&](const Fill& f) { fills.push_back(f); });
+    CHECK(r.filled == 50);
+    CHECK(r.cancelled == 0);
+    CHECK(fills.size() == 2);
+    CHECK(fills[0].self_trade && fills[0].maker_id == 1);
+    CHECK(!fills[1].self_trade && fills[1].maker_id == 2 && fills[1].qty == 50);
+}
+
+// Without STP, own quantity trades like any other, so the FOK fills.
+static void test_fok_without_stp_counts_everything() {
+    OrderBook book(5000, 25000, 16);
+    seed(book);
+    MatchResult r = book.add(limit(10, OrderType::BUY, 100.00, 100, 2, TimeInForce::FOK), [](const Fill&) {});
+    CHECK(r.filled == 100);
+    CHECK(r.cancelled == 0);
+}
+
+// Order ids stay findable through heavy rest/cancel churn in the fixed-size id table,
+// including ids that collide on their home slot.
+static void test_cancel_churn() {
+    OrderBook book(5000, 25000, 64);
+    auto no_fill = [](const Fill&) {};
+    std::vector<uint64_t> ids;
+    for (uint64_t i = 1; i <= 64; ++i) ids.push_back(i << 40);
+    for (int round = 0; round < 50; ++round) {
+        for (uint64_t id : ids) CHECK(book.add(limit(id + round, OrderType::BUY, 90.00, 10, 1), no_fill).rested == 10);
+        CHECK(book.resting() == 64);
+        CHECK(book.add(limit(ids[3] + round, OrderType::BUY, 90.00, 10, 1), no_fill).rejected);
+        for (size_t k = 0; k < ids.size(); k += 2) CHECK(book.cancel(ids[k] + round));
+        for (size_t k = 0; k < ids.size(); k += 2) CHECK(!book.cancel(ids[k] + round));
+        CHECK(book.resting() == 32);
+        for (size_t k = 1; k < ids.size(); k += 2) CHECK(book.cancel(ids[k] + round));
+        CHECK(book.resting() == 0);
+    }
+    CHECK(book.bid_qty_at(9000) == 0);
+}
+
+int main() {
+    test_fok_stp_ignores_own_liquidity();
+    test_fok_stp_own_liquidity_first();
+    test_fok_without_stp_counts_everything();
+    test_cancel_churn();
+    return test_result("order_book_test");
+}
@@ -0,0 +1,40 @@
+#include <vector>
+#include "reorder_buffer.hpp"
+#include "tests/test_util.hpp"
+
+// Seq 2 never comes. A duplicate of 1 arriving after the hold limit gives up the gap
+// and releases 3, just like a fresh arrival would.
+static void test_duplicate_ends_expired_hold() {
+    ReorderBuffer<uint64_t> buffer(8, 100);
+    std::vector<uint64_t> out;
+    auto emit = [&](uint64_t v, uint64_t) { out.push_back(v); };
+    buffer.push(1, 0, 1, emit);
+    buffer.push(3, 10, 3, emit);
+    CHECK((out == std::vector<uint64_t>{1}));
+    buffer.push(1, 200, 1, emit);
+    CHECK((out == std::vector<uint64_t>{1, 3}));
+    CHECK(buffer.stats().duplicates == 1);
+    CHECK(buffer.stats().lost == 1);
+    CHECK(buffer.stats().hold_timeouts == 1);
+}
+
+// At end of stream, flush() gives up every gap and releases what waits behind them.
+static void test_flush_releases_everything_held() {
+    ReorderBuffer<uint64_t> buffer(8, 1000000);
+    std::vector<uint64_t> out;
+    auto emit = [&](uint64_t v, uint64_t) { out.push_back(v); };
+    for (uint64_t seq : {1, 3, 5, 6}) buffer.push(seq, seq, seq, emit);
+    CHECK(buffer.pending() == 3);
+    buffer.flush(10, emit);
+    CHECK((out == std::vector<uint64_t>{1, 3, 5, 6}));
+    CHECK(buffer.pending() == 0);
+    CHECK(buffer.next_expected() == 7);
+    CHECK(buffer.stats().lost == 2);
+    CHECK(buffer.stats().delivered == 4);
+}
+
+int main() {
+    test_duplicate_ends_expired_hold();
+    test_flush_releases_everything_held();
+    return test_result("reorder_buffer_test");
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the tests in tests/: each test is its own executable and exits
+// non-zero if any CHECK failed. Works with NDEBUG, unlike assert.
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures()++;                                                        \
+        }                                                                             \
+    } while (0)
+
+inline int test_result(const char* name) {
+    if (test_failures()) std::fprintf(stderr, "%s: %d check(s) failed\n", name, test_failures());
+    else std::printf("%s: ok\n", name);
+    return test_failures() ? 1 : 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Raw timestamp counter. On x86 this is the invariant TSC (one instruction, no syscall);
+// elsewhere it falls back to steady_clock nanoseconds, so one tick is one ns.
+inline uint64_t tsc_now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Ticks per nanosecond, measured once against steady_clock over ~10ms on first use.
+inline double tsc_ticks_per_ns() {
+    static const double rate = [] {
+#if defined(__x86_64__) || defined(__i386__)
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t c0 = tsc_now();
+        while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(10)) {}
+        uint64_t c1 = tsc_now();
+        double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count());
+        return static_cast<double>(c1 - c0) / ns;
+#else
+        return 1.0;
+#endif
+    }();
+    return rate;
+}
+
+inline uint64_t tsc_to_ns(uint64_t ticks) { return static_cast<uint64_t>(ticks / tsc_ticks_per_ns()); }
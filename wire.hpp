@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "order.hpp"
+
+// Frame layout shared by the loopback transports and the venue emulator:
+//   [WireHeader][Order x count]      client -> venue
+//   [WireHeader][ExecReport x count] venue -> client
+// The venue echoes seq and send_ts_ns so the sender can compute round-trip time.
+constexpr uint32_t WIRE_MAGIC = 0x564C4C50;
+constexpr uint16_t VENUE_TCP_PORT = 45101;
+constexpr uint16_t VENUE_UDP_PORT = 45102;
+constexpr const char* VENUE_SHM_NAME = "/llp_venue";
+constexpr size_t MAX_FRAME_BYTES = 60000; // fits a single UDP datagram
+constexpr uint16_t FEED_A_PORT = 45103;   // A/B order feed lines, one FeedPacket per datagram
+constexpr uint16_t FEED_B_PORT = 45104;
+constexpr uint16_t INGRESS_PORT = 45105;  // client order entry, one IngressPacket per datagram
+
+enum class MsgType : uint16_t {
+    ORDER_BATCH = 1,
+    EXEC_BATCH = 2
+};
+
+struct WireHeader {
+    uint32_t magic;
+    MsgType msg_type;
+    uint16_t count;
+    uint64_t seq;
+    uint64_t send_ts_ns;
+};
+
+// Sequenced order feed message; the same seq goes out on both lines.
+struct FeedPacket {
+    uint32_t magic;
+    uint32_t line;
+    uint64_t seq;
+    uint64_t send_ts_ns;
+    Order order;
+};
+
+// Client order entry message; seq counts per client (Order::client_id) from 1.
+struct IngressPacket {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t seq;
+    uint64_t send_ts_ns;
+    Order order;
+};
+
+enum class ExecType : uint8_t {
+    ACK = 0,
+    FILL = 1,
+    REJECT = 2,
+    CANCEL = 3,   // unsolicited: IOC/FOK/market remainder, expired DAY order
+    TRIGGERED = 4 // stop or stop-limit activated, now working
+};
+
+struct ExecReport {
+    uint64_t order_id;
+    uint32_t last_qty;
+    uint32_t last_price_cents;
+    uint32_t leaves_qty;
+    ExecType type;
+};
+
+inline uint64_t wire_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+constexpr size_t max_frame_items() { return (MAX_FRAME_BYTES - sizeof(WireHeader)) / sizeof(T); }
+
+// Encodes as many items as fit one frame and returns that count; the caller carries the
+// rest into later frames.
+template <typename T>
+size_t encode_frame(MsgType type, uint64_t seq, uint64_t send_ts_ns, const T* items, size_t n, std::vector<char>& out) {
+    if (n > max_frame_items<T>()) n = max_frame_items<T>();
+    WireHeader hdr{WIRE_MAGIC, type, static_cast<uint16_t>(n), seq, send_ts_ns};
+    out.resize(sizeof(hdr) + n * sizeof(T));
+    std::memcpy(out.data(), &hdr, sizeof(hdr));
+    if (n) std::memcpy(out.data() + sizeof(hdr), items, n * sizeof(T));
+    return n;
+}
+
+// Total frame length implied by a header, or 0 if the header is not ours.
+template <typename T>
+size_t frame_length(const WireHeader& hdr) {
+    if (hdr.magic != WIRE_MAGIC) return 0;
+    return sizeof(WireHeader) + static_cast<size_t>(hdr.count) * sizeof(T);
+}
+
+template <typename T>
+bool decode_frame(const char* data, size_t len, MsgType expected, WireHeader& hdr, std::vector<T>& items) {
+    if (len < sizeof(WireHeader)) return false;
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.msg_type != expected) return false;
+    size_t need = frame_length<T>(hdr);
+    if (need == 0 || len < need) return false;
+    items.resize(hdr.count);
+    if (hdr.count) std::memcpy(items.data(), data + sizeof(hdr), hdr.count * sizeof(T));
+    return true;
+}